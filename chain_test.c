@@ -0,0 +1,124 @@
+//  chain_test.c
+//  2020-03-16  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  Unit tests for hash chains.
+
+#include "test_hex.h"
+#include "hash_chain.h"
+
+//  alg, n, prefix length, counter bytes, first counter, steps, result;
+//  results from iterating hashlib (and an SM3 model) outside this tree
+
+static const struct {
+	int alg, n, pl, cl;
+	uint32_t ctr, steps;
+	const char *md;
+} chain_tv[8] = {
+	{ CHAIN_SHA256, 32, 22, 1, 3, 10,
+	 "65348D1C173A0F3CF4C3E4E073EF2F53D59BAA560DCC62202B503365AB2A71E7" },
+	{ CHAIN_SHA256, 24, 22, 1, 3, 10,
+	 "4DCCF6407F04F5255843F55D5250C5691F632F5419F9393E" },
+	{ CHAIN_SHAKE256, 32, 22, 1, 3, 10,
+	 "A0A2BE622A5B2AE2DB61FE0CA4EA34EDDDE1DBE9DFC175B873F13EEC5B850280" },
+	{ CHAIN_SHAKE256, 24, 22, 1, 3, 10,
+	 "B2BA99F872728B3C578D41817E7A8D249C58E6109DFAF879" },
+	{ CHAIN_SM3, 32, 22, 1, 3, 10,
+	 "405FCCFB75310F347453D263E7D212F513FB5D7E125659B935269787576AB299" },
+	{ CHAIN_SHA256, 16, 82, 4, 0, 15,
+	 "D77A1C6E93B016025F12D2FEE9FB72F5" },
+	{ CHAIN_SHAKE256, 16, 150, 4, 0, 15,
+	 "39240DA311ED82D37BDF3227A0601E67" },
+	{ CHAIN_SM3, 24, 90, 2, 250, 12,
+	 "F45E436E502C9F551A939BC8672F6CEE8E6A7B979D57E236" }
+};
+
+static const char *chain_alg[3] = { "SHA2-256", "SHAKE256", "SM3" };
+
+static void chain_pre(uint8_t * pre, int pl)
+{
+	int i;
+
+	for (i = 0; i < pl; i++)
+		pre[i] = 0x11 * i + 5;
+}
+
+static void chain_x0(uint8_t * x, int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++)
+		x[i] = 0xA0 + 3 * i;
+}
+
+//  hash_chain_x() gives a lane the next chain when one ends: 29 chains of
+//  0 to 10 steps with mixed n, against hash_chain() one at a time
+
+static int test_chain_x(int alg, const char *lab)
+{
+	int i, fail = 0;
+	uint8_t pre[22], x[29][32], ref[32], *xp[29];
+	uint32_t ctr[29], steps[29];
+	hash_chain_t hc[29];
+	const hash_chain_t *hp[29];
+
+	chain_pre(pre, 22);
+	for (i = 0; i < 29; i++) {
+		pre[20] = i;						//  LMS chain index
+		fail += hash_chain_init(&hc[i], alg, 16 + 8 * (i % 3),
+								pre, 22, 1) != 0;
+		hp[i] = &hc[i];
+		chain_x0(x[i], 32);
+		x[i][0] = i;
+		xp[i] = x[i];
+		ctr[i] = i % 5;
+		steps[i] = (7 * i) % 11;
+	}
+
+	hash_chain_x(xp, hp, ctr, steps, 29);
+
+	for (i = 0; i < 29; i++) {
+		chain_x0(ref, 32);
+		ref[0] = i;
+		hash_chain(ref, &hc[i], ctr[i], steps[i]);
+		fail += memcmp(ref, x[i], hc[i].n) != 0;
+	}
+
+	return chkret(lab, 0, fail);
+}
+
+int test_hash_chain()
+{
+	int i, fail = 0;
+	uint8_t pre[160], x[32];
+	char lab[40];
+	hash_chain_t hc;
+
+	for (i = 0; i < 8; i++) {
+		snprintf(lab, sizeof(lab), "%s-%d chain",
+				 chain_alg[chain_tv[i].alg], 8 * chain_tv[i].n);
+		chain_pre(pre, chain_tv[i].pl);
+		fail += chkret(lab, 0, hash_chain_init(&hc, chain_tv[i].alg,
+											   chain_tv[i].n, pre,
+											   chain_tv[i].pl,
+											   chain_tv[i].cl));
+		chain_x0(x, chain_tv[i].n);
+		hash_chain(x, &hc, chain_tv[i].ctr, chain_tv[i].steps);
+		fail += chkhex(lab, x, chain_tv[i].n, chain_tv[i].md);
+	}
+
+	for (i = 0; i < 3; i++) {
+		snprintf(lab, sizeof(lab), "%s chain lanes", chain_alg[i]);
+		fail += test_chain_x(i, lab);
+	}
+
+	//  counter, value, and padding do not fit in the last block
+
+	chain_pre(pre, 30);
+	fail += chkret("hash_chain_init(SHA2-256, 30)", -1,
+				   hash_chain_init(&hc, CHAIN_SHA256, 32, pre, 30, 1));
+	fail += chkret("hash_chain_init(n=20)", -1,
+				   hash_chain_init(&hc, CHAIN_SHA256, 20, pre, 22, 1));
+
+	return fail;
+}
@@ -0,0 +1,339 @@
+//  hash_chain.c
+//  2020-03-16  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  Hash chains x = H(prefix | ctr | x). Only the counter and the previous
+//  value change from step to step, so everything else is set up once in
+//  hash_chain_init(): the state after the full prefix blocks and the last
+//  block with the prefix tail and padding. For SHA2-256 and SM3 a step
+//  writes the counter and the output words of the previous compression
+//  into that block and runs one compression; there is no context, no
+//  padding, and no copy of the block. SHAKE256 keeps the state after
+//  absorbing everything but "ctr | x", and a step XORs those in and runs
+//  one permutation.
+
+#include <string.h>
+#include "hash_chain.h"
+#include "sha2_wrap.h"
+#include "sha3_wrap.h"
+#include "sm3_wrap.h"
+#include "rv_endian.h"
+
+#define CHAIN_X_MAX 16						//  SHAKE256 states per group
+
+//  counter "ctr" to its place in block or state "b"; XOR for SHAKE256
+
+static void chain_ctr(uint8_t * b, const hash_chain_t * hc, uint32_t ctr)
+{
+	int i;
+
+	for (i = hc->cl - 1; i >= 0; i--) {
+		b[hc->co + i] ^= ctr;
+		ctr >>= 8;
+	}
+}
+
+//  Merkle-Damgard last block "tail | 0 | 0 | padding" of "len" bytes
+
+static int chain_md_blk(hash_chain_t * hc, const uint8_t * tail, int i,
+						uint64_t len)
+{
+	if (i + hc->cl + hc->n > 55)
+		return -1;
+
+	memcpy(hc->b, tail, i);
+	hc->co = i;
+	hc->xo = i + hc->cl;
+	i += hc->cl + hc->n;
+	memset(hc->b + hc->co, 0x00, i - hc->co);
+	hc->b[i++] = 0x80;
+	memset(hc->b + i, 0x00, 56 - i);
+	put64u_be(hc->b + 56, len << 3);
+
+	return 0;
+}
+
+//  === SHA2-256 and SM3 ===
+
+static int chain256_init(hash_chain_t * hc,
+						 const void *prefix, size_t prefixlen)
+{
+	int i;
+	sha2_256_ctx_t ctx;
+
+	sha2_256_init(&ctx);					//  all full prefix blocks
+	sha2_256_update(&ctx, prefix, prefixlen);
+	if (chain_md_blk(hc, ctx.b, ctx.len & 63,
+					 prefixlen + hc->cl + hc->n))
+		return -1;
+	for (i = 0; i < 8; i++)
+		hc->h[i] = ctx.s[i];
+
+	return 0;
+}
+
+static int chain_sm3_init(hash_chain_t * hc,
+						  const void *prefix, size_t prefixlen)
+{
+	int i;
+	sm3_ctx_t ctx;
+
+	sm3_init(&ctx);							//  all full prefix blocks
+	sm3_update(&ctx, prefix, prefixlen);
+	if (chain_md_blk(hc, ctx.b, ctx.len & 63,
+					 prefixlen + hc->cl + hc->n))
+		return -1;
+	for (i = 0; i < 8; i++)
+		hc->h[i] = ctx.s[i];
+
+	return 0;
+}
+
+//  next block from chain value words v[] and counter "ctr"; "b" already
+//  has the prefix tail and padding, and the counter bytes are zero
+
+static void chain_md_put(uint8_t * b, const hash_chain_t * hc,
+						 const uint32_t v[8], uint32_t ctr)
+{
+	int i;
+
+	memset(b + hc->co, 0x00, hc->cl);
+	chain_ctr(b, hc, ctr);
+	for (i = 0; i < (hc->n >> 2); i++)
+		put32u_be(b + hc->xo + 4 * i, v[i]);
+}
+
+//  === SHAKE256 ===
+
+static int chain_shake_init(hash_chain_t * hc,
+							const void *prefix, size_t prefixlen)
+{
+	int i;
+	sha3_ctx_t ctx;
+
+	shake256_init(&ctx);					//  "prefix" absorbed
+	shake_update(&ctx, prefix, prefixlen);
+	if (ctx.pt + hc->cl + hc->n > ctx.rsiz - 1)
+		return -1;
+
+	hc->co = ctx.pt;
+	hc->xo = ctx.pt + hc->cl;
+	ctx.st.b[hc->xo + hc->n] ^= 0x1F;		//  padding of "ctr | x"
+	ctx.st.b[ctx.rsiz - 1] ^= 0x80;
+	for (i = 0; i < 25; i++)
+		hc->st[i] = ctx.st.d[i];
+
+	return 0;
+}
+
+//  === Interface ===
+
+int hash_chain_init(hash_chain_t * hc, int alg, int n,
+					const void *prefix, size_t prefixlen, int ctrlen)
+{
+	if ((n != 16 && n != 24 && n != 32) || ctrlen < 0 || ctrlen > 4)
+		return -1;
+
+	memset(hc, 0x00, sizeof(hash_chain_t));
+	hc->alg = alg;
+	hc->n = n;
+	hc->cl = ctrlen;
+
+	if (alg == CHAIN_SHA256)
+		return chain256_init(hc, prefix, prefixlen);
+	if (alg == CHAIN_SHAKE256)
+		return chain_shake_init(hc, prefix, prefixlen);
+	if (alg == CHAIN_SM3)
+		return chain_sm3_init(hc, prefix, prefixlen);
+
+	return -1;
+}
+
+void hash_chain(uint8_t * x, const hash_chain_t * hc,
+				uint32_t ctr, uint32_t steps)
+{
+	int i;
+	uint32_t v[8];
+	uint64_t st[25];
+	uint8_t b[64];
+
+	if (steps == 0)
+		return;
+
+	if (hc->alg == CHAIN_SHAKE256) {
+		for (; steps > 0; steps--) {
+			memcpy(st, hc->st, sizeof(st));
+			chain_ctr((uint8_t *) st, hc, ctr++);
+			for (i = 0; i < hc->n; i++)
+				((uint8_t *) st)[hc->xo + i] ^= x[i];
+			sha3_keccakp(st);
+			memcpy(x, st, hc->n);
+		}
+		return;
+	}
+
+	memcpy(b, hc->b, 64);					//  SHA2-256 or SM3
+	memcpy(b + hc->xo, x, hc->n);
+	chain_ctr(b, hc, ctr++);
+	for (;;) {
+		for (i = 0; i < 8; i++)
+			v[i] = hc->h[i];
+		if (hc->alg == CHAIN_SHA256)
+			sha256_blocks(v, b, 1);
+		else
+			sm3_blocks(v, b, 1);
+		if (--steps == 0)
+			break;
+		chain_md_put(b, hc, v, ctr++);
+	}
+	for (i = 0; i < (hc->n >> 2); i++)
+		put32u_be(x + 4 * i, v[i]);
+}
+
+//  === Lanes ===
+
+//  SHA2-256: lane j runs chain c[j] in block b[j]; a lane that finishes
+//  gets the next chain before the following sha256_mb call
+
+static void chain256_x(uint8_t * x[], const hash_chain_t * const hc[],
+					   const uint32_t ctr[], const uint32_t steps[],
+					   size_t cnt)
+{
+	int i, j, lanes;
+	size_t k, c[SHA2_MB_MAX];
+	uint32_t mask, p[SHA2_MB_MAX], r[SHA2_MB_MAX], s[8 * SHA2_MB_MAX];
+	uint32_t v[8];
+	uint8_t b[SHA2_MB_MAX][64];
+	const uint8_t *bp[SHA2_MB_MAX];
+	const hash_chain_t *h;
+
+	lanes = sha256_mb_lanes;
+	memset(s, 0, sizeof(s));
+	memset(b, 0, sizeof(b));
+	for (j = 0; j < lanes; j++)
+		bp[j] = b[j];
+
+	k = 0;
+	mask = 0;
+	for (;;) {
+		for (j = 0; j < lanes; j++) {		//  refill idle lanes
+			if ((mask >> j) & 1)
+				continue;
+			while (k < cnt && steps[k] == 0)
+				k++;
+			if (k == cnt)
+				break;
+			h = hc[k];
+			c[j] = k;
+			p[j] = ctr[k] + 1;
+			r[j] = steps[k];
+			memcpy(b[j], h->b, 64);
+			memcpy(b[j] + h->xo, x[k], h->n);
+			chain_ctr(b[j], h, ctr[k]);
+			mask |= 1u << j;
+			k++;
+		}
+		if (mask == 0)
+			break;
+
+		for (j = 0; j < lanes; j++) {
+			if ((mask >> j) & 1) {
+				for (i = 0; i < 8; i++)
+					s[lanes * i + j] = hc[c[j]]->h[i];
+			}
+		}
+		sha256_mb(s, bp, mask);
+		for (j = 0; j < lanes; j++) {
+			if ((mask >> j) & 1) {
+				h = hc[c[j]];
+				for (i = 0; i < 8; i++)
+					v[i] = s[lanes * i + j];
+				if (--r[j] == 0) {
+					for (i = 0; i < (h->n >> 2); i++)
+						put32u_be(x[c[j]] + 4 * i, v[i]);
+					mask &= ~(1u << j);
+				} else {
+					chain_md_put(b[j], h, v, p[j]++);
+				}
+			}
+		}
+	}
+}
+
+//  SHAKE256: the first "act" states are in use; a finished chain is
+//  replaced by the last one so that sha3_keccakp_x gets consecutive states
+
+static void chain_shake_x(uint8_t * x[], const hash_chain_t * const hc[],
+						  const uint32_t ctr[], const uint32_t steps[],
+						  size_t cnt)
+{
+	int j;
+	size_t i, k, act, c[CHAIN_X_MAX];
+	uint32_t p[CHAIN_X_MAX], r[CHAIN_X_MAX];
+	uint64_t st[CHAIN_X_MAX * 25];
+	uint8_t v[CHAIN_X_MAX][32], *b;
+	const hash_chain_t *h;
+
+	k = 0;
+	act = 0;
+	for (;;) {
+		while (act < CHAIN_X_MAX && k < cnt) {	//  refill
+			if (steps[k] > 0) {
+				c[act] = k;
+				p[act] = ctr[k];
+				r[act] = steps[k];
+				memcpy(v[act], x[k], hc[k]->n);
+				act++;
+			}
+			k++;
+		}
+		if (act == 0)
+			break;
+
+		for (i = 0; i < act; i++) {
+			h = hc[c[i]];
+			b = (uint8_t *) & st[25 * i];
+			memcpy(b, h->st, 200);
+			chain_ctr(b, h, p[i]);
+			for (j = 0; j < h->n; j++)
+				b[h->xo + j] ^= v[i][j];
+		}
+		sha3_keccakp_x(st, act);
+		for (i = 0; i < act; i++) {
+			memcpy(v[i], &st[25 * i], hc[c[i]]->n);
+			p[i]++;
+			r[i]--;
+		}
+
+		for (i = 0; i < act;) {				//  remove finished chains
+			if (r[i] == 0) {
+				memcpy(x[c[i]], v[i], hc[c[i]]->n);
+				act--;
+				c[i] = c[act];
+				p[i] = p[act];
+				r[i] = r[act];
+				memcpy(v[i], v[act], 32);
+			} else {
+				i++;
+			}
+		}
+	}
+}
+
+void hash_chain_x(uint8_t * x[], const hash_chain_t * const hc[],
+				  const uint32_t ctr[], const uint32_t steps[], size_t cnt)
+{
+	size_t i;
+
+	if (cnt == 0)
+		return;
+
+	if (hc[0]->alg == CHAIN_SHA256) {
+		chain256_x(x, hc, ctr, steps, cnt);
+	} else if (hc[0]->alg == CHAIN_SHAKE256) {
+		chain_shake_x(x, hc, ctr, steps, cnt);
+	} else {								//  no SM3 lanes; one at a time
+		for (i = 0; i < cnt; i++)
+			hash_chain(x[i], hc[i], ctr[i], steps[i]);
+	}
+}
@@ -0,0 +1,43 @@
+//  hash_chain.h
+//  2020-03-16  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  Iterated hash chains x = H(prefix | ctr | x) of LMS (SP 800-208),
+//  WOTS+ and SLH-DSA with SHA2-256, SHAKE256, and SM3
+
+#ifndef _HASH_CHAIN_H_
+#define _HASH_CHAIN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CHAIN_SHA256	0
+#define CHAIN_SHAKE256	1
+#define CHAIN_SM3		2
+
+typedef struct {							//  hash chain
+	int alg, n;								//  CHAIN_xxx, value bytes
+	int co, cl, xo;							//  counter offset, bytes; value
+	uint32_t h[8];							//  state after the prefix blocks
+	uint8_t b[64];							//  last block, ctr = x = 0
+	uint64_t st[25];						//  SHAKE256 state, ctr = x = 0
+} hash_chain_t;
+
+//  Chain of "alg" with "n" byte values (16, 24, or 32; SHA2-256/192 is
+//  CHAIN_SHA256 with n = 24). Message is "prefix | ctr | x" with a big
+//  endian counter of "ctrlen" bytes (0 to 4). Counter, value, and padding
+//  must fit in the last block. Returns 0 on success, -1 if not.
+int hash_chain_init(hash_chain_t * hc, int alg, int n,
+					const void *prefix, size_t prefixlen, int ctrlen);
+
+//  x = H(prefix | ctr | x) for ctr, ctr + 1, .., ctr + steps - 1.
+void hash_chain(uint8_t * x, const hash_chain_t * hc,
+				uint32_t ctr, uint32_t steps);
+
+//  "cnt" chains at once, chain i is hash_chain(x[i], hc[i], ctr[i],
+//  steps[i]). All must have the same "alg". A lane of sha256_mb or a state
+//  of sha3_keccakp_x takes the next chain as soon as one finishes.
+void hash_chain_x(uint8_t * x[], const hash_chain_t * const hc[],
+				  const uint32_t ctr[], const uint32_t steps[], size_t cnt);
+
+#endif
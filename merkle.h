@@ -0,0 +1,142 @@
+//  merkle.h
+//  2020-03-10  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  Merkle hash trees over SHA2-256, SHA2-512, and SM3 (RFC 6962 shape)
+
+#ifndef _MERKLE_H_
+#define _MERKLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+//  hash functions
+
+#define MERKLE_SHA256	0
+#define MERKLE_SHA512	1
+#define MERKLE_SM3		2
+
+#define MERKLE_HLEN_MAX	64					//  largest hash (SHA2-512)
+#define MERKLE_PFX_MAX	64					//  longest domain prefix
+#define MERKLE_LEV_MAX	65					//  levels with 2^64 leaves
+
+//  === Hashing (merkle_hash.c) ===
+
+typedef struct {							//  hash and domain separation
+	int alg, hlen;							//  MERKLE_xxx, hash bytes
+	size_t lpfxlen, npfxlen;				//  prefix lengths
+	uint8_t lpfx[MERKLE_PFX_MAX];			//  leaf hash prefix
+	uint8_t npfx[MERKLE_PFX_MAX];			//  node hash prefix
+} merkle_hash_t;
+
+//  Set hash "alg" and leaf and node prefixes. Returns 0, or -1 on error.
+int merkle_hash_init(merkle_hash_t * mh, int alg,
+					 const void *lpfx, size_t lpfxlen,
+					 const void *npfx, size_t npfxlen);
+
+//  RFC 6962 prefixes: leaf 0x00, node 0x01
+#define merkle_hash_rfc6962(mh, alg) \
+	merkle_hash_init(mh, alg, "\x00", 1, "\x01", 1)
+
+//  Leaf hash H(lpfx | in) to "md".
+void merkle_leaf(const merkle_hash_t * mh, uint8_t * md,
+				 const void *in, size_t inlen);
+
+//  Node hashes H(npfx | left | right) of "n" consecutive left, right pairs
+//  of hlen bytes each at "lr" to "md"; "md" may overlap the start of "lr".
+//  SHA2 nodes go through the lanes of sha256_mb / sha512_mb.
+void merkle_node_x(const merkle_hash_t * mh, uint8_t * md,
+				   const uint8_t * lr, size_t n);
+
+//  Check an audit path of "plen" hashes for leaf hash "lh" at index "i"
+//  of a tree with "n" leaves. Returns 0 if it leads to "root".
+int merkle_path_verify(const merkle_hash_t * mh, const uint8_t * root,
+					   size_t n, size_t i, const uint8_t * lh,
+					   const uint8_t * path, size_t plen);
+
+//  Check an RFC 6962 consistency proof of "plen" hashes between a tree of
+//  "m1" leaves with "root1" and a tree of "m2" leaves with "root2".
+//  Returns 0 if the first tree is a prefix of the second.
+int merkle_consistency_verify(const merkle_hash_t * mh,
+							  size_t m1, const uint8_t * root1,
+							  size_t m2, const uint8_t * root2,
+							  const uint8_t * proof, size_t plen);
+
+//  === Tree builder (merkle_tree.c) ===
+
+typedef struct {							//  complete tree in memory
+	merkle_hash_t h;						//  hash parameters
+	size_t n;								//  number of leaves
+	int nlev;								//  levels, leaves to root
+	size_t off[MERKLE_LEV_MAX];				//  first node of each level
+	size_t cnt[MERKLE_LEV_MAX];				//  nodes on each level
+	uint8_t *t;								//  all nodes, level by level
+} merkle_tree_t;
+
+//  Build a tree from "n" leaves leaf[i] of leaflen[i] bytes. Returns 0 on
+//  success, -1 if out of memory.
+int merkle_tree_build(merkle_tree_t * mt, const merkle_hash_t * mh,
+					  const void *leaf[], const size_t leaflen[], size_t n);
+
+//  The same in steps, for threads: merkle_tree_alloc() sets up the levels
+//  of "n" leaves and returns 0, or -1 if out of memory. Then hash leaves
+//  "start" .. "end" - 1 with merkle_tree_leaves(), and nodes "start" ..
+//  "end" - 1 of each level k = 1 .. nlev - 1 with merkle_tree_level(),
+//  after all of level k - 1. Ranges of one level may run concurrently.
+int merkle_tree_alloc(merkle_tree_t * mt, const merkle_hash_t * mh,
+					  size_t n);
+void merkle_tree_leaves(merkle_tree_t * mt, const void *leaf[],
+						const size_t leaflen[], size_t start, size_t end);
+void merkle_tree_level(merkle_tree_t * mt, int k, size_t start, size_t end);
+
+//  Root hash (hlen bytes); the hash of an empty string if "n" is zero.
+const uint8_t *merkle_tree_root(const merkle_tree_t * mt);
+
+//  Audit path of leaf "i" to "path" (up to nlev - 1 hashes); returns the
+//  number of hashes. The nodes are read from the tree, not recomputed.
+size_t merkle_tree_path(uint8_t * path, const merkle_tree_t * mt, size_t i);
+
+//  Free the node array.
+void merkle_tree_free(merkle_tree_t * mt);
+
+//  === Append-only log (merkle_log.c) ===
+
+#define MERKLE_LOG_HDR	64					//  file header bytes
+
+typedef struct {							//  append-only log
+	merkle_hash_t h;						//  hash parameters
+	uint64_t n;								//  number of leaves
+	uint8_t fr[64][MERKLE_HLEN_MAX];		//  frontier: subtree for bit k of n
+	int fd;									//  file, or -1 in memory
+	size_t cap;								//  allocated node slots
+	uint8_t *map;							//  header and nodes
+} merkle_log_t;
+
+//  Open log file "fn" (created if it does not exist) or an in-memory log if
+//  "fn" is NULL. Returns 0, or -1 on error or hash parameter mismatch.
+int merkle_log_open(merkle_log_t * ml, const merkle_hash_t * mh,
+					const char *fn);
+
+//  Append a leaf. Returns 0, or -1 if out of memory or file space.
+int merkle_log_append(merkle_log_t * ml, const void *in, size_t inlen);
+
+//  Root of the first "m" leaves (m <= n) to "md". Returns 0 or -1.
+int merkle_log_root(uint8_t * md, const merkle_log_t * ml, uint64_t m);
+
+//  Inclusion proof of leaf "i" in the tree of the first "m" leaves to
+//  "path" (up to 64 hashes). Returns the number of hashes, or -1.
+int merkle_log_inclusion(uint8_t * path, const merkle_log_t * ml,
+						 uint64_t i, uint64_t m);
+
+//  Consistency proof between trees of "m1" and "m2" leaves, m1 <= m2 <= n,
+//  to "proof" (up to 65 hashes). Returns the number of hashes, or -1.
+int merkle_log_consistency(uint8_t * proof, const merkle_log_t * ml,
+						   uint64_t m1, uint64_t m2);
+
+//  Flush the file mapping. Returns 0 or -1.
+int merkle_log_sync(merkle_log_t * ml);
+
+//  Unmap and close.
+void merkle_log_close(merkle_log_t * ml);
+
+#endif
@@ -0,0 +1,337 @@
+//  merkle_hash.c
+//  2020-03-10  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  Leaf and node hashing with domain separation prefixes, path checking.
+
+#include <string.h>
+#include "merkle.h"
+#include "sha2_wrap.h"
+#include "sm3_wrap.h"
+#include "rv_endian.h"
+
+//  set parameters
+
+int merkle_hash_init(merkle_hash_t * mh, int alg,
+					 const void *lpfx, size_t lpfxlen,
+					 const void *npfx, size_t npfxlen)
+{
+	switch (alg) {
+	case MERKLE_SHA256:
+	case MERKLE_SM3:
+		mh->hlen = 32;
+		break;
+	case MERKLE_SHA512:
+		mh->hlen = 64;
+		break;
+	default:
+		return -1;
+	}
+	if (lpfxlen > MERKLE_PFX_MAX || npfxlen > MERKLE_PFX_MAX)
+		return -1;
+
+	mh->alg = alg;
+	mh->lpfxlen = lpfxlen;
+	mh->npfxlen = npfxlen;
+	memcpy(mh->lpfx, lpfx, lpfxlen);
+	memcpy(mh->npfx, npfx, npfxlen);
+
+	return 0;
+}
+
+//  H(pfx | in)
+
+static void mhash(const merkle_hash_t * mh, uint8_t * md,
+				  const uint8_t * pfx, size_t pfxlen,
+				  const void *in, size_t inlen)
+{
+	union {
+		sha2_256_ctx_t s256;
+		sha2_512_ctx_t s512;
+		sm3_ctx_t sm3;
+	} c;
+
+	switch (mh->alg) {
+
+	case MERKLE_SHA256:
+		sha2_256_init(&c.s256);
+		sha2_256_update(&c.s256, pfx, pfxlen);
+		sha2_256_update(&c.s256, in, inlen);
+		sha2_256_final(md, &c.s256);
+		break;
+
+	case MERKLE_SHA512:
+		sha2_512_init(&c.s512);
+		sha2_512_update(&c.s512, pfx, pfxlen);
+		sha2_512_update(&c.s512, in, inlen);
+		sha2_512_final(md, &c.s512);
+		break;
+
+	case MERKLE_SM3:
+		sm3_init(&c.sm3);
+		sm3_update(&c.sm3, pfx, pfxlen);
+		sm3_update(&c.sm3, in, inlen);
+		sm3_final(md, &c.sm3);
+		break;
+	}
+}
+
+//  leaf hash
+
+void merkle_leaf(const merkle_hash_t * mh, uint8_t * md,
+				 const void *in, size_t inlen)
+{
+	mhash(mh, md, mh->lpfx, mh->lpfxlen, in, inlen);
+}
+
+//  SM3 as a lane kernel with one lane (there is no multi-buffer SM3)
+
+static void sm3_x1(uint32_t * s, const uint8_t * const blk[], uint32_t mask)
+{
+	if (mask & 1)
+		sm3_blocks(s, blk[0], 1);
+}
+
+//  Node hashes with 64-byte blocks and 32-byte results, "lanes" nodes at a
+//  time. Every node is npfx | left | right, so all lanes run the same
+//  blocks. A whole prefix block is compressed once to a midstate; the rest
+//  of the prefix and the padding are set up once in the lane buffers, and
+//  each node only copies its pair in. Without a prefix remainder the pair
+//  is a whole block that is read in place.
+
+static void node256(const merkle_hash_t * mh, uint8_t * md,
+					const uint8_t * lr, size_t n, const uint32_t iv[8],
+					void (*mb)(uint32_t *, const uint8_t * const *,
+							   uint32_t), int lanes)
+{
+	int i, j, b, nt;
+	size_t q, r;
+	uint32_t mask, h[8], s[8 * SHA2_MB_MAX];
+	uint8_t tb[SHA2_MB_MAX][192];
+	const uint8_t *bp[SHA2_MB_MAX];
+
+	r = mh->npfxlen % 64;
+	nt = (r + 64 + 9 + 63) / 64;
+	for (j = 0; j < lanes; j++) {
+		memset(tb[j], 0x00, 64 * nt);
+		memcpy(tb[j], mh->npfx + mh->npfxlen - r, r);
+		tb[j][r + 64] = 0x80;
+		put64u_be(tb[j] + 64 * nt - 8, (mh->npfxlen + 64) << 3);
+		bp[j] = mh->npfx;
+	}
+
+	for (i = 0; i < 8; i++) {				//  midstate of the prefix
+		for (j = 0; j < lanes; j++)
+			s[lanes * i + j] = iv[i];
+	}
+	if (mh->npfxlen >= 64)
+		mb(s, bp, 1);
+	for (i = 0; i < 8; i++)
+		h[i] = s[lanes * i];
+
+	for (q = 0; q < n; q += lanes) {
+		mask = 0;
+		for (j = 0; j < lanes; j++) {
+			if (q + j < n) {
+				if (r > 0)
+					memcpy(tb[j] + r, lr + 64 * (q + j), 64);
+				mask |= 1u << j;
+			}
+			for (i = 0; i < 8; i++)
+				s[lanes * i + j] = h[i];
+		}
+		for (b = 0; b < nt; b++) {
+			for (j = 0; j < lanes; j++) {
+				if (r == 0 && b == 0 && ((mask >> j) & 1))
+					bp[j] = lr + 64 * (q + j);
+				else
+					bp[j] = tb[j] + 64 * b;
+			}
+			mb(s, bp, mask);
+		}
+		for (j = 0; j < lanes && q + j < n; j++) {
+			for (i = 0; i < 8; i++)
+				put32u_be(md + 32 * (q + j) + 4 * i, s[lanes * i + j]);
+		}
+	}
+}
+
+//  .. and with 128-byte blocks and 64-byte results (SHA2-512); a prefix of
+//  up to MERKLE_PFX_MAX bytes never fills a block
+
+static void node512(const merkle_hash_t * mh, uint8_t * md,
+					const uint8_t * lr, size_t n)
+{
+	int i, j, b, nt, lanes;
+	size_t q, r;
+	uint32_t mask;
+	uint64_t s[8 * SHA2_MB_MAX];
+	uint8_t tb[SHA2_MB_MAX][256];
+	const uint8_t *bp[SHA2_MB_MAX];
+
+	lanes = sha512_mb_lanes;
+	r = mh->npfxlen;
+	nt = (r + 128 + 17 + 127) / 128;
+	for (j = 0; j < lanes; j++) {
+		memset(tb[j], 0x00, 128 * nt);
+		memcpy(tb[j], mh->npfx, r);
+		tb[j][r + 128] = 0x80;
+		put64u_be(tb[j] + 128 * nt - 8, (r + 128) << 3);
+	}
+
+	for (q = 0; q < n; q += lanes) {
+		mask = 0;
+		for (j = 0; j < lanes; j++) {
+			if (q + j < n) {
+				if (r > 0)
+					memcpy(tb[j] + r, lr + 128 * (q + j), 128);
+				mask |= 1u << j;
+			}
+			for (i = 0; i < 8; i++)
+				s[lanes * i + j] = sha2_512_h0[i];
+		}
+		for (b = 0; b < nt; b++) {
+			for (j = 0; j < lanes; j++) {
+				if (r == 0 && b == 0 && ((mask >> j) & 1))
+					bp[j] = lr + 128 * (q + j);
+				else
+					bp[j] = tb[j] + 128 * b;
+			}
+			sha512_mb(s, bp, mask);
+		}
+		for (j = 0; j < lanes && q + j < n; j++) {
+			for (i = 0; i < 8; i++)
+				put64u_be(md + 64 * (q + j) + 8 * i, s[lanes * i + j]);
+		}
+	}
+}
+
+//  a level of node hashes in the lanes of sha256_mb / sha512_mb; SM3 goes
+//  through the same code one node at a time
+
+void merkle_node_x(const merkle_hash_t * mh, uint8_t * md,
+				   const uint8_t * lr, size_t n)
+{
+	sm3_ctx_t c;
+
+	switch (mh->alg) {
+
+	case MERKLE_SHA256:
+		node256(mh, md, lr, n, sha2_256_h0, sha256_mb, sha256_mb_lanes);
+		break;
+
+	case MERKLE_SHA512:
+		node512(mh, md, lr, n);
+		break;
+
+	case MERKLE_SM3:
+		sm3_init(&c);
+		node256(mh, md, lr, n, c.s, sm3_x1, 1);
+		break;
+	}
+}
+
+//  walk up from the leaf; the last node of an odd level has no sibling
+
+int merkle_path_verify(const merkle_hash_t * mh, const uint8_t * root,
+					   size_t n, size_t i, const uint8_t * lh,
+					   const uint8_t * path, size_t plen)
+{
+	size_t j, hlen;
+	uint8_t lr[2 * MERKLE_HLEN_MAX];
+
+	if (i >= n)
+		return -1;
+
+	hlen = mh->hlen;
+	memcpy(lr, lh, hlen);
+
+	for (j = 0; n > 1; i >>= 1, n = (n + 1) >> 1) {
+		if ((i ^ 1) >= n)					//  promoted as it is
+			continue;
+		if (j >= plen)
+			return -1;
+		if (i & 1) {
+			memcpy(lr + hlen, lr, hlen);
+			memcpy(lr, path + j * hlen, hlen);
+		} else {
+			memcpy(lr + hlen, path + j * hlen, hlen);
+		}
+		merkle_node_x(mh, lr, lr, 1);
+		j++;
+	}
+
+	if (j != plen || memcmp(lr, root, hlen) != 0)
+		return -1;
+
+	return 0;
+}
+
+//  RFC 9162 Sect. 2.1.4.2; the old root is rebuilt alongside the new one
+
+int merkle_consistency_verify(const merkle_hash_t * mh,
+							  size_t m1, const uint8_t * root1,
+							  size_t m2, const uint8_t * root2,
+							  const uint8_t * proof, size_t plen)
+{
+	size_t j, fn, sn, hlen;
+	const uint8_t *c;
+	uint8_t fr[2 * MERKLE_HLEN_MAX], sr[2 * MERKLE_HLEN_MAX];
+
+	hlen = mh->hlen;
+
+	if (m1 > m2)
+		return -1;
+	if (m1 == 0)							//  empty tree is a prefix of all
+		return plen == 0 ? 0 : -1;
+	if (m1 == m2)
+		return plen == 0 && memcmp(root1, root2, hlen) == 0 ? 0 : -1;
+
+	j = 0;									//  power of 2: proof omits root1
+	if ((m1 & (m1 - 1)) == 0) {
+		c = root1;
+	} else {
+		if (plen == 0)
+			return -1;
+		c = proof;
+		j = 1;
+	}
+	memcpy(fr, c, hlen);
+	memcpy(sr, c, hlen);
+
+	fn = m1 - 1;
+	sn = m2 - 1;
+	while (fn & 1) {
+		fn >>= 1;
+		sn >>= 1;
+	}
+
+	for (; j < plen; j++) {
+		c = proof + j * hlen;
+		if (sn == 0)
+			return -1;
+		if ((fn & 1) || fn == sn) {			//  sibling on the left
+			memcpy(fr + hlen, fr, hlen);
+			memcpy(fr, c, hlen);
+			merkle_node_x(mh, fr, fr, 1);
+			memcpy(sr + hlen, sr, hlen);
+			memcpy(sr, c, hlen);
+			merkle_node_x(mh, sr, sr, 1);
+			while (!(fn & 1) && fn != 0) {
+				fn >>= 1;
+				sn >>= 1;
+			}
+		} else {							//  only in the new tree
+			memcpy(sr + hlen, c, hlen);
+			merkle_node_x(mh, sr, sr, 1);
+		}
+		fn >>= 1;
+		sn >>= 1;
+	}
+
+	if (sn != 0 || memcmp(fr, root1, hlen) != 0 ||
+		memcmp(sr, root2, hlen) != 0)
+		return -1;
+
+	return 0;
+}
@@ -0,0 +1,362 @@
+//  merkle_log.c
+//  2020-03-11  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  Append-only Merkle log (RFC 6962 tree shape). Nodes of complete
+//  subtrees are written once, in post order, to a memory-mapped file: the
+//  leaf hash goes to the end and is merged with the frontier subtrees of
+//  the bits that carry when "n" is incremented, so an append is amortized
+//  two hashes. Roots and proofs combine stored subtrees; only the nodes on
+//  the right edge of a tree that is not complete are hashed.
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "merkle.h"
+#include "rv_endian.h"
+
+//  header: magic, n, alg, hlen
+
+static const uint8_t mlog_magic[8] = "MERKLOG";
+
+//  number of ones
+
+static int popc64(uint64_t x)
+{
+	int i;
+
+	for (i = 0; x != 0; i++)
+		x &= x - 1;
+
+	return i;
+}
+
+//  node "j" of level "k" was written when leaf m - 1 was appended
+
+static uint8_t *mlnode(const merkle_log_t * ml, int k, uint64_t j)
+{
+	uint64_t m;
+
+	m = ((j + 1) << k) - 1;
+
+	return ml->map + MERKLE_LOG_HDR +
+		(2 * m - popc64(m) + k) * ml->h.hlen;
+}
+
+//  (re)allocate or (re)map room for "cap" nodes; on failure the old
+//  mapping stays as it was, so the log can still be read
+
+static int mlmap(merkle_log_t * ml, size_t cap)
+{
+	size_t sz;
+	uint8_t *p;
+
+	sz = MERKLE_LOG_HDR + cap * ml->h.hlen;
+
+	if (ml->fd < 0) {
+		p = realloc(ml->map, sz);
+		if (p == NULL)
+			return -1;
+	} else {								//  grow the file, then remap
+		if (ftruncate(ml->fd, sz) != 0)
+			return -1;
+		p = mmap(NULL, sz, PROT_READ | PROT_WRITE, MAP_SHARED, ml->fd, 0);
+		if (p == MAP_FAILED)
+			return -1;
+		if (ml->map != NULL)
+			munmap(ml->map, MERKLE_LOG_HDR + ml->cap * ml->h.hlen);
+	}
+	ml->map = p;
+	ml->cap = cap;
+
+	return 0;
+}
+
+//  hash of the "cnt" leaves from "lo"; "lo" is a multiple of a power of
+//  two not smaller than "cnt", so they split into the complete subtrees of
+//  the bits of "cnt", largest first. Fold them from the right.
+
+static void mlsub(uint8_t * md, const merkle_log_t * ml,
+				  uint64_t lo, uint64_t cnt)
+{
+	int k;
+	size_t hlen;
+	uint64_t x;
+	uint8_t lr[2 * MERKLE_HLEN_MAX];
+
+	hlen = ml->h.hlen;
+	x = lo + cnt;
+
+	for (k = 0; !((cnt >> k) & 1); k++)
+		;
+	x -= 1llu << k;
+	memcpy(lr, mlnode(ml, k, x >> k), hlen);
+
+	for (k++; k < 64; k++) {
+		if (!((cnt >> k) & 1))
+			continue;
+		x -= 1llu << k;
+		memcpy(lr + hlen, lr, hlen);
+		memcpy(lr, mlnode(ml, k, x >> k), hlen);
+		merkle_node_x(&ml->h, lr, lr, 1);
+	}
+
+	memcpy(md, lr, hlen);
+}
+
+//  largest power of two smaller than "n" (n >= 2)
+
+static uint64_t mlsplit(uint64_t n)
+{
+	uint64_t k;
+
+	for (k = 1; 2 * k < n; k <<= 1)
+		;
+
+	return k;
+}
+
+//  RFC 6962 PATH(i, D[lo : lo + cnt])
+
+static int mlpath(uint8_t * path, const merkle_log_t * ml,
+				  uint64_t i, uint64_t lo, uint64_t cnt)
+{
+	int j;
+	uint64_t k;
+
+	if (cnt <= 1)
+		return 0;
+
+	k = mlsplit(cnt);
+	if (i < lo + k) {
+		j = mlpath(path, ml, i, lo, k);
+		mlsub(path + j * ml->h.hlen, ml, lo + k, cnt - k);
+	} else {
+		j = mlpath(path, ml, i, lo + k, cnt - k);
+		mlsub(path + j * ml->h.hlen, ml, lo, k);
+	}
+
+	return j + 1;
+}
+
+//  RFC 6962 SUBPROOF(m, D[lo : lo + cnt], b)
+
+static int mlcons(uint8_t * proof, const merkle_log_t * ml,
+				  uint64_t m, uint64_t lo, uint64_t cnt, int b)
+{
+	int j;
+	uint64_t k;
+
+	if (m == cnt) {
+		if (b)
+			return 0;
+		mlsub(proof, ml, lo, cnt);
+		return 1;
+	}
+
+	k = mlsplit(cnt);
+	if (m <= k) {
+		j = mlcons(proof, ml, m, lo, k, b);
+		mlsub(proof + j * ml->h.hlen, ml, lo + k, cnt - k);
+	} else {
+		j = mlcons(proof, ml, m - k, lo + k, cnt - k, 0);
+		mlsub(proof + j * ml->h.hlen, ml, lo, k);
+	}
+
+	return j + 1;
+}
+
+//  open
+
+int merkle_log_open(merkle_log_t * ml, const merkle_hash_t * mh,
+					const char *fn)
+{
+	int k;
+	size_t sz;
+	struct stat st;
+
+	ml->h = *mh;
+	ml->n = 0;
+	ml->fd = -1;
+	ml->cap = 0;
+	ml->map = NULL;
+
+	if (fn != NULL) {
+		ml->fd = open(fn, O_RDWR | O_CREAT, 0644);
+		if (ml->fd < 0)
+			return -1;
+		if (fstat(ml->fd, &st) != 0)
+			goto fail;
+		sz = st.st_size;
+	} else {
+		sz = 0;
+	}
+
+	if (sz < MERKLE_LOG_HDR) {				//  new log
+		if (mlmap(ml, 1024) != 0)
+			goto fail;
+		memset(ml->map, 0, MERKLE_LOG_HDR);
+		memcpy(ml->map, mlog_magic, 8);
+		put64u_be(ml->map + 8, 0);
+		put32u_be(ml->map + 16, mh->alg);
+		put32u_be(ml->map + 20, mh->hlen);
+		return 0;
+	}
+
+	ml->cap = (sz - MERKLE_LOG_HDR) / mh->hlen;
+	ml->map = mmap(NULL, MERKLE_LOG_HDR + ml->cap * mh->hlen,
+				   PROT_READ | PROT_WRITE, MAP_SHARED, ml->fd, 0);
+	if (ml->map == MAP_FAILED) {
+		ml->map = NULL;
+		goto fail;
+	}
+
+	ml->n = get64u_be(ml->map + 8);
+	if (memcmp(ml->map, mlog_magic, 8) != 0 ||
+		get32u_be(ml->map + 16) != (uint32_t) mh->alg ||
+		get32u_be(ml->map + 20) != (uint32_t) mh->hlen ||
+		ml->n > ml->cap || 2 * ml->n - popc64(ml->n) > ml->cap)
+		goto fail;
+
+	for (k = 0; k < 64; k++) {				//  frontier from the stored nodes
+		if ((ml->n >> k) & 1)
+			memcpy(ml->fr[k], mlnode(ml, k, (ml->n >> k) - 1), mh->hlen);
+	}
+
+	return 0;
+
+  fail:
+	merkle_log_close(ml);
+	return -1;
+}
+
+//  append a leaf
+
+int merkle_log_append(merkle_log_t * ml, const void *in, size_t inlen)
+{
+	int k;
+	size_t hlen, cap;
+	uint64_t n;
+	uint8_t lr[2 * MERKLE_HLEN_MAX];
+
+	hlen = ml->h.hlen;
+	n = ml->n;
+
+	if (2 * n + 1 > ml->cap) {				//  an opened file may be small
+		cap = 2 * ml->cap;
+		if (cap < 2 * n + 2)
+			cap = 2 * n + 2;
+		if (mlmap(ml, cap) != 0)
+			return -1;
+	}
+
+	merkle_leaf(&ml->h, lr, in, inlen);
+	memcpy(mlnode(ml, 0, n), lr, hlen);
+
+	for (k = 0; (n >> k) & 1; k++) {		//  merge with frontier
+		memcpy(lr + hlen, lr, hlen);
+		memcpy(lr, ml->fr[k], hlen);
+		merkle_node_x(&ml->h, lr, lr, 1);
+		memcpy(mlnode(ml, k + 1, n >> (k + 1)), lr, hlen);
+	}
+	memcpy(ml->fr[k], lr, hlen);
+
+	ml->n = n + 1;
+	put64u_be(ml->map + 8, ml->n);
+
+	return 0;
+}
+
+//  root of "m" leaves
+
+int merkle_log_root(uint8_t * md, const merkle_log_t * ml, uint64_t m)
+{
+	int k;
+	size_t hlen;
+	merkle_hash_t h0;
+	uint8_t lr[2 * MERKLE_HLEN_MAX];
+
+	if (m > ml->n)
+		return -1;
+
+	if (m == 0) {							//  hash of an empty string
+		h0 = ml->h;
+		h0.lpfxlen = 0;
+		merkle_leaf(&h0, md, "", 0);
+		return 0;
+	}
+
+	if (m < ml->n) {
+		mlsub(md, ml, 0, m);
+		return 0;
+	}
+
+	hlen = ml->h.hlen;						//  current root from the frontier
+	for (k = 0; !((m >> k) & 1); k++)
+		;
+	memcpy(lr, ml->fr[k], hlen);
+	for (k++; k < 64; k++) {
+		if ((m >> k) & 1) {
+			memcpy(lr + hlen, lr, hlen);
+			memcpy(lr, ml->fr[k], hlen);
+			merkle_node_x(&ml->h, lr, lr, 1);
+		}
+	}
+	memcpy(md, lr, hlen);
+
+	return 0;
+}
+
+//  inclusion proof
+
+int merkle_log_inclusion(uint8_t * path, const merkle_log_t * ml,
+						 uint64_t i, uint64_t m)
+{
+	if (m > ml->n || i >= m)
+		return -1;
+
+	return mlpath(path, ml, i, 0, m);
+}
+
+//  consistency proof
+
+int merkle_log_consistency(uint8_t * proof, const merkle_log_t * ml,
+						   uint64_t m1, uint64_t m2)
+{
+	if (m1 > m2 || m2 > ml->n)
+		return -1;
+	if (m1 == 0)
+		return 0;
+
+	return mlcons(proof, ml, m1, 0, m2, 1);
+}
+
+//  flush
+
+int merkle_log_sync(merkle_log_t * ml)
+{
+	if (ml->fd < 0)
+		return 0;
+
+	return msync(ml->map, MERKLE_LOG_HDR + ml->cap * ml->h.hlen, MS_SYNC);
+}
+
+//  close
+
+void merkle_log_close(merkle_log_t * ml)
+{
+	if (ml->fd < 0) {
+		free(ml->map);
+	} else {
+		if (ml->map != NULL)
+			munmap(ml->map, MERKLE_LOG_HDR + ml->cap * ml->h.hlen);
+		close(ml->fd);
+	}
+	ml->map = NULL;
+	ml->fd = -1;
+	ml->cap = 0;
+}
@@ -0,0 +1,322 @@
+//  merkle_test.c
+//  2020-03-10  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  Merkle tree roots and audit paths. RFC 6962 roots for prefixes of the
+//  Certificate Transparency test leaves (SHA2-512 and SM3 computed with
+//  an independent recursive implementation).
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include "test_hex.h"
+#include "merkle.h"
+#include "sha2_wrap.h"
+
+//  test leaves
+
+static const char *merkle_leaf_tv[8] = {
+	"", "00", "10", "2021", "3031", "40414243",
+	"5051525354555657", "606162636465666768696A6B6C6D6E6F"
+};
+
+//  roots for n = 0, 1, 2, 3, 5, 7, 8 leaves
+
+static const int merkle_n_tv[7] = { 0, 1, 2, 3, 5, 7, 8 };
+
+static const char *merkle_root_tv[3][7] = {
+	{
+	 "E3B0C44298FC1C149AFBF4C8996FB92427AE41E4649B934CA495991B7852B855",
+	 "6E340B9CFFB37A989CA544E6BB780A2C78901D3FB33738768511A30617AFA01D",
+	 "FAC54203E7CC696CF0DFCB42C92A1D9DBAF70AD9E621F4BD8D98662F00E3C125",
+	 "AEB6BCFE274B70A14FB067A5E5578264DB0FA9B51AF5E0BA159158F329E06E77",
+	 "4E3BBB1F7B478DCFE71FB631631519A3BCA12C9AEFCA1612BFCE4C13A86264D4",
+	 "DDB89BE403809E325750D3D263CD78929C2942B7942A34B77E122C9594A74C8C",
+	 "5DC9DA79A70659A9AD559CB701DED9A2AB9D823AAD2F4960CFE370EFF4604328" },
+	{
+	 "CF83E1357EEFB8BDF1542850D66D8007D620E4050B5715DC83F4A921D36CE9CE"
+	 "47D0D13C5D85F2B0FF8318D2877EEC2F63B931BD47417A81A538327AF927DA3E",
+	 "B8244D028981D693AF7B456AF8EFA4CAD63D282E19FF14942C246E50D9351D22"
+	 "704A802A71C3580B6370DE4CEB293C324A8423342557D4E5C38438F0E36910EE",
+	 "EC13509B4B0D6060733DB20529399ECC2236E8043ABF5A2344D0DAEB24F3D9B9"
+	 "84A5A78999C70ABE94FB4C1BFFDFE5E90332F9E54FFDD754187986431E3D7666",
+	 "252EABB32BBC85386F2C1B428D532CCDC0B84DDC455058C071CBA0684F2117FE"
+	 "74623E44E010B520B47EBB43859405D06921DBE0BABF45BC3AA74293423360C0",
+	 "DEF9FE3B474FDA66965513D3CA4606617139D5A04A318957B89CD6D196640385"
+	 "B523FF619A9BD22D4B750F8E5B30465A4D4C81B718E95D71C6DDE946AF579E49",
+	 "63F7A63312288705B17D764FA8147BFAFFE9D5F2968BE4532E50280FA04FA6E2"
+	 "926463D7ED17F5C7A49892AACCD377F4B034147B18C88E7019A83BD52C9F6DD2",
+	 "74A3BFCC6FB0A1B4492DBE97E5E690FDDEA80C27A1256E60C55C03957CA948E5"
+	 "64BDB5416DC8FB8F5B4E8A5A7DC6BBFA84A0D917A8DEB26244A35661E37644F9" },
+	{
+	 "1AB21D8355CFA17F8E61194831E81A8F22BEC8C728FEFB747ED035EB5082AA2B",
+	 "2DAEF60E7A0B8F5E024C81CD2AB3109F2B4F155CF83ADEB2AE5532F74A157FDF",
+	 "0B990FE0C7AD70F1BF1A1262F2C7908EA48146B14253A6DB99F2917AB1F5CC4D",
+	 "209EC96A210D662A964772680E8544D18CAB7B88FFEC3E00962220349B56EA56",
+	 "BB10C996AEEBBCDC69BE3715FC847344DE77442D37A5AB8213DA9F41785B103B",
+	 "BD36C22A1AC6FF4308E0C3CC1A85BF0FFA30538EC60A55C70413AB15D45DB4D2",
+	 "BC48BA7A709184B5F2A631E1ADEB8DC2A0D4C018C1D6CC89B5664FE154C93B38" }
+};
+
+static const char *merkle_alg_tv[3] = { "SHA2-256", "SHA2-512", "SM3" };
+
+//  node prefix lengths
+
+static const size_t merkle_pfx_tv[6] = { 0, 1, 55, 56, 63, 64 };
+
+int test_merkle()
+{
+	int a, j, fail = 0;
+	size_t i, k, n, plen, len[100];
+	uint8_t buf[8][16], lh[MERKLE_HLEN_MAX];
+	uint8_t nd[37 * 2 * MERKLE_HLEN_MAX], in2[sizeof(nd)], lr[sizeof(nd)];
+	uint8_t path[MERKLE_LEV_MAX * MERKLE_HLEN_MAX];
+	const void *leaf[100];
+	char lab[64];
+	merkle_hash_t mh, h2;
+	merkle_tree_t mt, mt2;
+
+	for (i = 0; i < 8; i++) {
+		len[i] = readhex(buf[i], sizeof(buf[i]), merkle_leaf_tv[i]);
+		leaf[i] = buf[i];
+	}
+
+	//  roots
+
+	for (a = 0; a < 3; a++) {
+		merkle_hash_rfc6962(&mh, a);
+		for (j = 0; j < 7; j++) {
+			if (merkle_tree_build(&mt, &mh, leaf, len, merkle_n_tv[j]) != 0) {
+				fail++;
+				continue;
+			}
+			snprintf(lab, sizeof(lab), "Merkle %s n=%d",
+					 merkle_alg_tv[a], merkle_n_tv[j]);
+			fail += chkhex(lab, merkle_tree_root(&mt), mh.hlen,
+						   merkle_root_tv[a][j]);
+			merkle_tree_free(&mt);
+		}
+	}
+
+	//  audit paths of every leaf, tampered paths fail
+
+	for (i = 0; i < 100; i++) {
+		len[i] = 1 + i % 13;
+		leaf[i] = (const uint8_t *) merkle_leaf_tv[7] + i % 20;
+	}
+
+	for (a = 0; a < 3; a++) {
+		merkle_hash_rfc6962(&mh, a);
+		for (n = 1; n <= 100; n += n < 20 ? 1 : 17) {
+			if (merkle_tree_build(&mt, &mh, leaf, len, n) != 0) {
+				fail++;
+				continue;
+			}
+			for (i = 0; i < n; i++) {
+				merkle_leaf(&mh, lh, leaf[i], len[i]);
+				plen = merkle_tree_path(path, &mt, i);
+				fail += merkle_path_verify(&mh, merkle_tree_root(&mt),
+										   n, i, lh, path, plen) != 0;
+				if (plen > 0) {
+					path[(plen - 1) * mh.hlen] ^= 1;
+					fail += merkle_path_verify(&mh, merkle_tree_root(&mt),
+											   n, i, lh, path, plen) != -1;
+					fail += merkle_path_verify(&mh, merkle_tree_root(&mt),
+											   n, i, lh, path, plen - 1) != -1;
+				}
+			}
+			merkle_tree_free(&mt);
+		}
+	}
+
+	//  node batches across lane groups against prefixed leaf hashes, for
+	//  prefixes that end anywhere in the first block; in place too
+
+	for (k = 0; k < sizeof(nd); k++)
+		nd[k] = (uint8_t) (k * k + 7);
+	for (a = 0; a < 3; a++) {
+		for (j = 0; j < 6; j++) {
+			merkle_hash_init(&mh, a, "", 0, nd, merkle_pfx_tv[j]);
+			merkle_hash_init(&h2, a, nd, merkle_pfx_tv[j], "", 0);
+			merkle_node_x(&mh, lr, nd, 37);
+			for (i = 0; i < 37; i++) {
+				merkle_leaf(&h2, lh, nd + 2 * mh.hlen * i, 2 * mh.hlen);
+				fail += memcmp(lr + mh.hlen * i, lh, mh.hlen) != 0;
+			}
+			memcpy(in2, nd, sizeof(in2));
+			merkle_node_x(&mh, in2, in2, 37);
+			fail += memcmp(in2, lr, 37 * mh.hlen) != 0;
+		}
+	}
+
+	//  ranges in any order give the same tree as merkle_tree_build()
+
+	for (a = 0; a < 3; a++) {
+		merkle_hash_rfc6962(&mh, a);
+		for (n = 0; n <= 100; n += 1 + n / 4) {
+			if (merkle_tree_build(&mt, &mh, leaf, len, n) != 0 ||
+				merkle_tree_alloc(&mt2, &mh, n) != 0) {
+				fail++;
+				continue;
+			}
+			for (i = (n + 6) / 7; i > 0; i--)
+				merkle_tree_leaves(&mt2, leaf, len, 7 * (i - 1), 7 * i);
+			for (j = 1; j < mt2.nlev; j++) {
+				for (i = (mt2.cnt[j] + 2) / 3; i > 0; i--)
+					merkle_tree_level(&mt2, j, 3 * (i - 1), 3 * i);
+			}
+			fail += mt2.nlev != mt.nlev;
+			fail += memcmp(mt2.t, mt.t,
+						   (mt.off[mt.nlev - 1] + 1) * mh.hlen) != 0;
+			merkle_tree_free(&mt);
+			merkle_tree_free(&mt2);
+		}
+	}
+
+	fail += merkle_hash_init(&mh, 3, "", 0, "", 0) != -1;
+	fail += merkle_hash_init(&mh, MERKLE_SM3, nd, 65, "", 0) != -1;
+
+	return chkret("Merkle tree", 0, fail);
+}
+
+//  append-only log against complete trees, proofs, reopened file
+
+int test_merkle_log()
+{
+	int a, fd, plen, fail = 0;
+	uint64_t i, m, m1, m2;
+	size_t len[80];
+	const void *leaf[80];
+	uint8_t md[MERKLE_HLEN_MAX], r1[MERKLE_HLEN_MAX], r2[MERKLE_HLEN_MAX];
+	uint8_t path[MERKLE_LEV_MAX * MERKLE_HLEN_MAX];
+	uint8_t tpath[MERKLE_LEV_MAX * MERKLE_HLEN_MAX];
+	char fn[] = "/tmp/merkle_log_XXXXXX";
+	merkle_hash_t mh;
+	merkle_tree_t mt;
+	merkle_log_t ml;
+	struct rlimit rl, rl2;
+
+	for (i = 0; i < 80; i++) {
+		len[i] = 1 + i % 11;
+		leaf[i] = (const uint8_t *) merkle_leaf_tv[7] + i % 21;
+	}
+
+	for (a = 0; a < 3; a++) {
+		merkle_hash_rfc6962(&mh, a);
+		if (merkle_log_open(&ml, &mh, NULL) != 0) {
+			fail++;
+			continue;
+		}
+
+		//  roots and inclusion proofs match the tree builder
+
+		for (m = 0; m <= 80; m++) {
+			merkle_tree_build(&mt, &mh, leaf, len, m);
+			fail += merkle_log_root(md, &ml, m) != 0;
+			fail += memcmp(md, merkle_tree_root(&mt), mh.hlen) != 0;
+			for (i = 0; i < m; i += 1 + m / 8) {
+				plen = merkle_log_inclusion(path, &ml, i, m);
+				fail += plen != (int) merkle_tree_path(tpath, &mt, i);
+				fail += plen > 0 && memcmp(path, tpath, plen * mh.hlen) != 0;
+			}
+			fail += merkle_log_inclusion(path, &ml, m, m) != -1;
+			merkle_tree_free(&mt);
+			if (m < 80)
+				fail += merkle_log_append(&ml, leaf[m], len[m]);
+		}
+		fail += merkle_log_root(md, &ml, 81) != -1;
+
+		//  consistency proofs between all sizes, one tampered hash fails
+
+		for (m2 = 1; m2 <= 80; m2 += 1 + (m2 > 20)) {
+			merkle_log_root(r2, &ml, m2);
+			for (m1 = 0; m1 <= m2; m1++) {
+				merkle_log_root(r1, &ml, m1);
+				plen = merkle_log_consistency(path, &ml, m1, m2);
+				fail += plen < 0;
+				fail += merkle_consistency_verify(&mh, m1, r1, m2, r2,
+												  path, plen) != 0;
+				if (plen > 0) {
+					path[mh.hlen * (plen - 1)] ^= 0x80;
+					fail += merkle_consistency_verify(&mh, m1, r1, m2, r2,
+													  path, plen) != -1;
+				}
+				if (m1 > 0 && m1 < m2) {
+					merkle_log_root(r1, &ml, m1 - 1);
+					plen = merkle_log_consistency(path, &ml, m1, m2);
+					fail += merkle_consistency_verify(&mh, m1, r1, m2, r2,
+													  path, plen) != -1;
+				}
+			}
+		}
+		merkle_log_close(&ml);
+	}
+
+	//  a file log continues after reopening
+
+	merkle_hash_rfc6962(&mh, MERKLE_SHA256);
+	fd = mkstemp(fn);
+	if (fd < 0)
+		return chkret("Merkle log", 0, fail + 1);
+	close(fd);
+
+	fail += merkle_log_open(&ml, &mh, fn);
+	for (i = 0; i < 37; i++)
+		fail += merkle_log_append(&ml, leaf[i], len[i]);
+	fail += merkle_log_sync(&ml);
+	merkle_log_close(&ml);
+
+	merkle_hash_rfc6962(&mh, MERKLE_SM3);	//  wrong hash is refused
+	fail += merkle_log_open(&ml, &mh, fn) != -1;
+
+	merkle_hash_rfc6962(&mh, MERKLE_SHA256);
+	fail += merkle_log_open(&ml, &mh, fn);
+	fail += ml.n != 37;
+	for (i = 37; i < 80; i++)
+		fail += merkle_log_append(&ml, leaf[i], len[i]);
+	merkle_tree_build(&mt, &mh, leaf, len, 80);
+	fail += merkle_log_root(md, &ml, 80);
+	fail += memcmp(md, merkle_tree_root(&mt), 32) != 0;
+	merkle_log_close(&ml);
+
+	//  a file that only just holds its nodes grows enough on append
+
+	fail += truncate(fn, 0) != 0;
+	fail += merkle_log_open(&ml, &mh, fn);
+	fail += merkle_log_append(&ml, leaf[0], len[0]);
+	merkle_log_close(&ml);
+	fail += truncate(fn, MERKLE_LOG_HDR + 32) != 0;
+	fail += merkle_log_open(&ml, &mh, fn);
+	fail += ml.cap != 1 || ml.n != 1;
+	for (i = 1; i < 80; i++)
+		fail += merkle_log_append(&ml, leaf[i], len[i]);
+	merkle_log_close(&ml);
+	fail += merkle_log_open(&ml, &mh, fn);
+	fail += merkle_log_root(md, &ml, 80);
+	fail += memcmp(md, merkle_tree_root(&mt), 32) != 0;
+
+	//  a failed append leaves the log readable
+
+	signal(SIGXFSZ, SIG_IGN);
+	getrlimit(RLIMIT_FSIZE, &rl);
+	rl2 = rl;
+	rl2.rlim_cur = MERKLE_LOG_HDR + ml.cap * 32;
+	setrlimit(RLIMIT_FSIZE, &rl2);
+	for (i = 80; 2 * i + 1 <= ml.cap; i++)
+		fail += merkle_log_append(&ml, leaf[i % 80], len[i % 80]);
+	fail += merkle_log_append(&ml, leaf[0], len[0]) != -1;
+	setrlimit(RLIMIT_FSIZE, &rl);
+	signal(SIGXFSZ, SIG_DFL);
+	fail += ml.map == NULL;
+	fail += merkle_log_root(md, &ml, 80);
+	fail += memcmp(md, merkle_tree_root(&mt), 32) != 0;
+	fail += merkle_log_inclusion(path, &ml, 3, ml.n) < 0;
+	fail += merkle_log_append(&ml, leaf[0], len[0]);
+
+	merkle_tree_free(&mt);
+	merkle_log_close(&ml);
+	unlink(fn);
+
+	return chkret("Merkle log", 0, fail);
+}
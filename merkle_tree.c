@@ -0,0 +1,142 @@
+//  merkle_tree.c
+//  2020-03-10  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  Level-by-level Merkle tree builder. All levels are kept in one array,
+//  leaves first. A node range of a level is one merkle_node_x() batch over
+//  the contiguous pairs below it, so the pairs go through the lane kernels.
+//  Ranges of one level only read the level below and write their own
+//  nodes, so a caller can hash them on separate threads. An odd last node
+//  is promoted as it is, which gives the RFC 6962 tree shape for any
+//  number of leaves.
+
+#include <stdlib.h>
+#include <string.h>
+#include "merkle.h"
+
+//  level sizes and the node array
+
+int merkle_tree_alloc(merkle_tree_t * mt, const merkle_hash_t * mh,
+					  size_t n)
+{
+	int k;
+	size_t hlen;
+
+	mt->h = *mh;
+	mt->n = n;
+	hlen = mh->hlen;
+
+	mt->off[0] = 0;
+	mt->cnt[0] = n > 0 ? n : 1;
+	for (k = 0; mt->cnt[k] > 1; k++) {
+		mt->off[k + 1] = mt->off[k] + mt->cnt[k];
+		mt->cnt[k + 1] = (mt->cnt[k] + 1) >> 1;
+	}
+	mt->nlev = k + 1;
+
+	mt->t = malloc((mt->off[k] + 1) * hlen);
+	if (mt->t == NULL)
+		return -1;
+
+	if (n == 0) {							//  hash of an empty string
+		merkle_hash_t h0 = *mh;
+		h0.lpfxlen = 0;
+		merkle_leaf(&h0, mt->t, "", 0);
+	}
+
+	return 0;
+}
+
+//  leaf hashes "start" .. "end" - 1
+
+void merkle_tree_leaves(merkle_tree_t * mt, const void *leaf[],
+						const size_t leaflen[], size_t start, size_t end)
+{
+	size_t i, hlen;
+
+	hlen = mt->h.hlen;
+	if (end > mt->n)
+		end = mt->n;
+	for (i = start; i < end; i++)
+		merkle_leaf(&mt->h, mt->t + i * hlen, leaf[i], leaflen[i]);
+}
+
+//  nodes "start" .. "end" - 1 of level k from level k - 1
+
+void merkle_tree_level(merkle_tree_t * mt, int k, size_t start, size_t end)
+{
+	size_t c, p, hlen;
+	uint8_t *src, *dst;
+
+	if (k < 1 || k >= mt->nlev)
+		return;
+	if (end > mt->cnt[k])
+		end = mt->cnt[k];
+	if (start >= end)
+		return;
+
+	hlen = mt->h.hlen;
+	c = mt->cnt[k - 1];
+	p = c >> 1;								//  nodes with two children
+	src = mt->t + mt->off[k - 1] * hlen;
+	dst = mt->t + mt->off[k] * hlen;
+
+	if (start < p)
+		merkle_node_x(&mt->h, dst + start * hlen, src + 2 * start * hlen,
+					  (end < p ? end : p) - start);
+	if (end > p)							//  odd last node
+		memcpy(dst + p * hlen, src + (c - 1) * hlen, hlen);
+}
+
+//  build, one range per level
+
+int merkle_tree_build(merkle_tree_t * mt, const merkle_hash_t * mh,
+					  const void *leaf[], const size_t leaflen[], size_t n)
+{
+	int k;
+
+	if (merkle_tree_alloc(mt, mh, n) != 0)
+		return -1;
+
+	merkle_tree_leaves(mt, leaf, leaflen, 0, n);
+	for (k = 1; k < mt->nlev; k++)
+		merkle_tree_level(mt, k, 0, mt->cnt[k]);
+
+	return 0;
+}
+
+//  root is the last node
+
+const uint8_t *merkle_tree_root(const merkle_tree_t * mt)
+{
+	return mt->t + mt->off[mt->nlev - 1] * mt->h.hlen;
+}
+
+//  siblings from the stored levels
+
+size_t merkle_tree_path(uint8_t * path, const merkle_tree_t * mt, size_t i)
+{
+	int k;
+	size_t j, hlen;
+
+	if (i >= mt->n)
+		return 0;
+
+	hlen = mt->h.hlen;
+	for (j = 0, k = 0; k + 1 < mt->nlev; k++, i >>= 1) {
+		if ((i ^ 1) >= mt->cnt[k])
+			continue;
+		memcpy(path + j * hlen, mt->t + (mt->off[k] + (i ^ 1)) * hlen, hlen);
+		j++;
+	}
+
+	return j;
+}
+
+//  free
+
+void merkle_tree_free(merkle_tree_t * mt)
+{
+	free(mt->t);
+	mt->t = NULL;
+}
@@ -2,15 +2,24 @@
 //  2020-04-30  Markku-Juhani O. Saarinen <mjos@pqshield.com>
 //  Copyright (c) 2020, PQShield Ltd. All rights reserved.
 
-//  RISC-V specific endianess support would be here (via intrinsics)
+//  RISC-V specific endianess support: REV8 intrinsics with Zbkb or Zbb
 
 #ifndef _RV_ENDIAN_H_
 #define _RV_ENDIAN_H_
 
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__riscv_zbkb) || defined(__riscv_zbb)
+#include <riscv_bitmanip.h>
+#endif
+
 //  revert if not big endian
 
 #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
 #define GREV_BE32(x) (x)
+#elif defined(__riscv_zbkb) || defined(__riscv_zbb)
+#define GREV_BE32(x) __riscv_rev8_32(x)
 #else
 	//  grev(x, 0x18) or rev8
 #define GREV_BE32(x) (	\
@@ -20,6 +29,14 @@
 
 #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
 #define GREV_BE64(x) (x)
+#elif (defined(__riscv_zbkb) || defined(__riscv_zbb)) && \
+	(__riscv_xlen == 32)
+//  RV32: no 64-bit rev8, reverse the two halves and swap them
+#define GREV_BE64(x) (									\
+	(((uint64_t) __riscv_rev8_32((uint32_t) (x))) << 32) |	\
+	((uint64_t) __riscv_rev8_32((uint32_t) ((x) >> 32))))
+#elif defined(__riscv_zbkb) || defined(__riscv_zbb)
+#define GREV_BE64(x) __riscv_rev8_64(x)
 #else
 //  RISC-V: grev(x, 0x38) or rev8(x)
 #define GREV_BE64(x) (						\
@@ -112,4 +129,23 @@ static inline void put64u_be(uint8_t * v, uint64_t x)
 	v[7] = x;
 }
 
+//  unaligned big endian loads for the block functions: memcpy() becomes a
+//  single (misaligned) LW / LD where allowed, followed by the byte reversal
+
+static inline uint32_t ld32u_be(const uint8_t * v)
+{
+	uint32_t x;
+
+	memcpy(&x, v, 4);
+	return GREV_BE32(x);
+}
+
+static inline uint64_t ld64u_be(const uint8_t * v)
+{
+	uint64_t x;
+
+	memcpy(&x, v, 8);
+	return GREV_BE64(x);
+}
+
 #endif
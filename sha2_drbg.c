@@ -0,0 +1,449 @@
+//  sha2_drbg.c
+//  2020-03-14  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  NIST SP 800-90A Rev. 1 Hash_DRBG and HMAC_DRBG with SHA2-256 and
+//  SHA2-512. The output loops call sha256_blocks / sha512_blocks directly:
+//  a Hash_DRBG "data" value (seedlen = 440 or 888 bits) plus its padding is
+//  exactly one block, and an HMAC_DRBG step V = HMAC(K, V) is two
+//  compressions from the cached midstates of K. An instance has no shared
+//  state, so each thread can own one without locking.
+
+#include <string.h>
+#include "sha2_wrap.h"
+#include "rv_endian.h"
+
+//  === Hash_DRBG (Sect. 10.1.1) ===
+
+typedef union {								//  either hash
+	sha2_256_ctx_t c256;
+	sha2_512_ctx_t c512;
+} dhash_t;
+
+static void dhash_init(dhash_t * h, int hlen)
+{
+	if (hlen == 32)
+		sha2_256_init(&h->c256);
+	else
+		sha2_512_init(&h->c512);
+}
+
+static void dhash_update(dhash_t * h, int hlen, const void *in, size_t inlen)
+{
+	if (inlen == 0)
+		return;
+	if (hlen == 32)
+		sha2_256_update(&h->c256, in, inlen);
+	else
+		sha2_512_update(&h->c512, in, inlen);
+}
+
+static void dhash_final(uint8_t * md, dhash_t * h, int hlen)
+{
+	if (hlen == 32)
+		sha2_256_final(md, &h->c256);
+	else
+		sha2_512_final(md, &h->c512);
+}
+
+//  Hash_df() of "np" concatenated strings p[i] of l[i] bytes, seedlen bytes
+
+static void hash_df(const hash_drbg_t * d, uint8_t * out,
+					const void *p[], const size_t l[], int np)
+{
+	int i;
+	uint8_t ctr, nb[4], t[64];
+	size_t n;
+	dhash_t h;
+
+	put32u_be(nb, d->seedlen << 3);
+	for (ctr = 1, n = 0; n < (size_t) d->seedlen; ctr++) {
+		dhash_init(&h, d->hlen);
+		dhash_update(&h, d->hlen, &ctr, 1);
+		dhash_update(&h, d->hlen, nb, 4);
+		for (i = 0; i < np; i++)
+			dhash_update(&h, d->hlen, p[i], l[i]);
+		dhash_final(t, &h, d->hlen);
+		i = d->seedlen - n < (size_t) d->hlen ? d->seedlen - n : d->hlen;
+		memcpy(out + n, t, i);
+		n += i;
+	}
+}
+
+//  v = (v + x) mod 2^(8 * vlen); x has "xlen" <= vlen bytes, big endian
+
+static void vadd(uint8_t * v, int vlen, const uint8_t * x, int xlen)
+{
+	int i;
+	unsigned c;
+
+	c = 0;
+	for (i = 1; i <= vlen; i++) {
+		c += v[vlen - i];
+		if (i <= xlen)
+			c += x[xlen - i];
+		v[vlen - i] = c;
+		c >>= 8;
+	}
+}
+
+//  V and C from the seed material
+
+static void hash_drbg_seed(hash_drbg_t * d, const void *p[],
+						   const size_t l[], int np)
+{
+	const void *q[2];
+	size_t ql[2];
+
+	hash_df(d, d->v, p, l, np);
+	q[0] = "\x00";
+	ql[0] = 1;
+	q[1] = d->v;
+	ql[1] = d->seedlen;
+	hash_df(d, d->c, q, ql, 2);
+	d->rc = 1;
+}
+
+int hash_drbg_init(hash_drbg_t * d, int hlen,
+				   const void *ent, size_t entlen,
+				   const void *nonce, size_t noncelen,
+				   const void *pers, size_t perslen)
+{
+	const void *p[3];
+	size_t l[3];
+
+	if (hlen != 32 && hlen != 64)
+		return -1;
+	d->hlen = hlen;
+	d->seedlen = hlen == 32 ? 55 : 111;
+	d->rci = DRBG_RESEED_INTERVAL;
+
+	p[0] = ent;
+	l[0] = entlen;
+	p[1] = nonce;
+	l[1] = noncelen;
+	p[2] = pers;
+	l[2] = perslen;
+	hash_drbg_seed(d, p, l, 3);
+
+	return 0;
+}
+
+void hash_drbg_reseed(hash_drbg_t * d, const void *ent, size_t entlen,
+					  const void *add, size_t addlen)
+{
+	uint8_t v[111];
+	const void *p[4];
+	size_t l[4];
+
+	memcpy(v, d->v, d->seedlen);
+	p[0] = "\x01";
+	l[0] = 1;
+	p[1] = v;
+	l[1] = d->seedlen;
+	p[2] = ent;
+	l[2] = entlen;
+	p[3] = add;
+	l[3] = addlen;
+	hash_drbg_seed(d, p, l, 4);
+}
+
+//  Hash(x | V | add) to "md"
+
+static void hash_drbg_h(uint8_t * md, const hash_drbg_t * d, uint8_t x,
+						const void *add, size_t addlen)
+{
+	dhash_t h;
+
+	dhash_init(&h, d->hlen);
+	dhash_update(&h, d->hlen, &x, 1);
+	dhash_update(&h, d->hlen, d->v, d->seedlen);
+	dhash_update(&h, d->hlen, add, addlen);
+	dhash_final(md, &h, d->hlen);
+}
+
+//  Hashgen(): "data" is one padded block; increment it in place
+
+static void hashgen256(uint8_t * out, size_t outlen, const uint8_t v[55])
+{
+	int i;
+	size_t l;
+	uint32_t s[8];
+	uint8_t b[64], t[32];
+
+	memcpy(b, v, 55);
+	b[55] = 0x80;
+	put64u_be(b + 56, 55 << 3);
+
+	while (outlen > 0) {
+		for (i = 0; i < 8; i++)
+			s[i] = sha2_256_h0[i];
+		sha256_blocks(s, b, 1);
+		for (i = 0; i < 8; i++)
+			put32u_be(t + 4 * i, s[i]);
+		l = outlen < 32 ? outlen : 32;
+		memcpy(out, t, l);
+		out += l;
+		outlen -= l;
+		for (i = 54; i >= 0 && ++b[i] == 0; i--)
+			;
+	}
+}
+
+static void hashgen512(uint8_t * out, size_t outlen, const uint8_t v[111])
+{
+	int i;
+	size_t l;
+	uint64_t s[8];
+	uint8_t b[128], t[64];
+
+	memcpy(b, v, 111);
+	b[111] = 0x80;
+	put64u_be(b + 112, 0);
+	put64u_be(b + 120, 111 << 3);
+
+	while (outlen > 0) {
+		for (i = 0; i < 8; i++)
+			s[i] = sha2_512_h0[i];
+		sha512_blocks(s, b, 1);
+		for (i = 0; i < 8; i++)
+			put64u_be(t + 8 * i, s[i]);
+		l = outlen < 64 ? outlen : 64;
+		memcpy(out, t, l);
+		out += l;
+		outlen -= l;
+		for (i = 110; i >= 0 && ++b[i] == 0; i--)
+			;
+	}
+}
+
+int hash_drbg_generate(hash_drbg_t * d, uint8_t * out, size_t outlen,
+					   const void *add, size_t addlen)
+{
+	uint8_t w[64], rc[8];
+
+	if (outlen > DRBG_MAX_REQUEST)
+		return -1;
+	if (d->rc > d->rci)
+		return 1;
+
+	if (addlen > 0) {
+		hash_drbg_h(w, d, 0x02, add, addlen);
+		vadd(d->v, d->seedlen, w, d->hlen);
+	}
+
+	if (d->hlen == 32)
+		hashgen256(out, outlen, d->v);
+	else
+		hashgen512(out, outlen, d->v);
+
+	hash_drbg_h(w, d, 0x03, NULL, 0);
+	vadd(d->v, d->seedlen, w, d->hlen);
+	vadd(d->v, d->seedlen, d->c, d->seedlen);
+	put64u_be(rc, d->rc);
+	vadd(d->v, d->seedlen, rc, 8);
+	d->rc++;
+
+	return 0;
+}
+
+//  === HMAC_DRBG (Sect. 10.1.2) ===
+
+//  new key K: its midstates
+
+static void hmac_drbg_rekey(hmac_drbg_t * d)
+{
+	if (d->hlen == 32)
+		hmac_sha2_256_key(&d->k256, d->k, 32);
+	else
+		hmac_sha2_512_key(&d->k512, d->k, 64);
+}
+
+//  HMAC(K, V | x | p[0] | .. | p[np - 1]) to "mac"; "x" is left out if < 0
+
+static void hmac_drbg_mac(uint8_t * mac, const hmac_drbg_t * d, int x,
+						  const void *p[], const size_t l[], int np)
+{
+	int i;
+	uint8_t b = x;
+	hmac_sha2_256_ctx_t h256;
+	hmac_sha2_512_ctx_t h512;
+
+	if (d->hlen == 32) {
+		hmac_sha2_256_init(&h256, &d->k256);
+		hmac_sha2_256_update(&h256, d->v, 32);
+		if (x >= 0)
+			hmac_sha2_256_update(&h256, &b, 1);
+		for (i = 0; i < np; i++) {
+			if (l[i] > 0)
+				hmac_sha2_256_update(&h256, p[i], l[i]);
+		}
+		hmac_sha2_256_final(mac, &h256);
+	} else {
+		hmac_sha2_512_init(&h512, &d->k512);
+		hmac_sha2_512_update(&h512, d->v, 64);
+		if (x >= 0)
+			hmac_sha2_512_update(&h512, &b, 1);
+		for (i = 0; i < np; i++) {
+			if (l[i] > 0)
+				hmac_sha2_512_update(&h512, p[i], l[i]);
+		}
+		hmac_sha2_512_final(mac, &h512);
+	}
+}
+
+//  HMAC_DRBG_Update() with the concatenation of p[i]
+
+static void hmac_drbg_update(hmac_drbg_t * d, const void *p[],
+							 const size_t l[], int np)
+{
+	int i;
+	size_t n;
+
+	n = 0;
+	for (i = 0; i < np; i++)
+		n += l[i];
+
+	hmac_drbg_mac(d->k, d, 0x00, p, l, np);
+	hmac_drbg_rekey(d);
+	hmac_drbg_mac(d->v, d, -1, NULL, NULL, 0);
+	if (n == 0)
+		return;
+	hmac_drbg_mac(d->k, d, 0x01, p, l, np);
+	hmac_drbg_rekey(d);
+	hmac_drbg_mac(d->v, d, -1, NULL, NULL, 0);
+}
+
+int hmac_drbg_init(hmac_drbg_t * d, int hlen,
+				   const void *ent, size_t entlen,
+				   const void *nonce, size_t noncelen,
+				   const void *pers, size_t perslen)
+{
+	const void *p[3];
+	size_t l[3];
+
+	if (hlen != 32 && hlen != 64)
+		return -1;
+	d->hlen = hlen;
+	d->rci = DRBG_RESEED_INTERVAL;
+	memset(d->k, 0x00, hlen);
+	memset(d->v, 0x01, hlen);
+	hmac_drbg_rekey(d);
+
+	p[0] = ent;
+	l[0] = entlen;
+	p[1] = nonce;
+	l[1] = noncelen;
+	p[2] = pers;
+	l[2] = perslen;
+	hmac_drbg_update(d, p, l, 3);
+	d->rc = 1;
+
+	return 0;
+}
+
+void hmac_drbg_reseed(hmac_drbg_t * d, const void *ent, size_t entlen,
+					  const void *add, size_t addlen)
+{
+	const void *p[2];
+	size_t l[2];
+
+	p[0] = ent;
+	l[0] = entlen;
+	p[1] = add;
+	l[1] = addlen;
+	hmac_drbg_update(d, p, l, 2);
+	d->rc = 1;
+}
+
+//  V = HMAC(K, V) repeatedly: the padded V block is set up once, and each
+//  step is an inner and an outer compression
+
+static void hmacgen256(uint8_t * out, size_t outlen, hmac_drbg_t * d)
+{
+	int i;
+	size_t l;
+	uint32_t s[8];
+	uint8_t b[64];
+
+	memcpy(b, d->v, 32);
+	b[32] = 0x80;
+	memset(b + 33, 0x00, 56 - 33);
+	put64u_be(b + 56, (64 + 32) << 3);
+
+	while (outlen > 0) {
+		for (i = 0; i < 8; i++)
+			s[i] = d->k256.hi[i];
+		sha256_blocks(s, b, 1);
+		for (i = 0; i < 8; i++) {
+			put32u_be(b + 4 * i, s[i]);
+			s[i] = d->k256.ho[i];
+		}
+		sha256_blocks(s, b, 1);
+		for (i = 0; i < 8; i++)
+			put32u_be(b + 4 * i, s[i]);
+		l = outlen < 32 ? outlen : 32;
+		memcpy(out, b, l);
+		out += l;
+		outlen -= l;
+	}
+	memcpy(d->v, b, 32);
+}
+
+static void hmacgen512(uint8_t * out, size_t outlen, hmac_drbg_t * d)
+{
+	int i;
+	size_t l;
+	uint64_t s[8];
+	uint8_t b[128];
+
+	memcpy(b, d->v, 64);
+	b[64] = 0x80;
+	memset(b + 65, 0x00, 120 - 65);
+	put64u_be(b + 120, (128 + 64) << 3);
+
+	while (outlen > 0) {
+		for (i = 0; i < 8; i++)
+			s[i] = d->k512.hi[i];
+		sha512_blocks(s, b, 1);
+		for (i = 0; i < 8; i++) {
+			put64u_be(b + 8 * i, s[i]);
+			s[i] = d->k512.ho[i];
+		}
+		sha512_blocks(s, b, 1);
+		for (i = 0; i < 8; i++)
+			put64u_be(b + 8 * i, s[i]);
+		l = outlen < 64 ? outlen : 64;
+		memcpy(out, b, l);
+		out += l;
+		outlen -= l;
+	}
+	memcpy(d->v, b, 64);
+}
+
+int hmac_drbg_generate(hmac_drbg_t * d, uint8_t * out, size_t outlen,
+					   const void *add, size_t addlen)
+{
+	const void *p[1];
+	size_t l[1];
+
+	if (outlen > DRBG_MAX_REQUEST)
+		return -1;
+	if (d->rc > d->rci)
+		return 1;
+
+	p[0] = add;
+	l[0] = addlen;
+	if (addlen > 0)
+		hmac_drbg_update(d, p, l, 1);
+
+	if (d->hlen == 32)
+		hmacgen256(out, outlen, d);
+	else
+		hmacgen512(out, outlen, d);
+
+	hmac_drbg_update(d, p, l, 1);
+	d->rc++;
+
+	return 0;
+}
@@ -0,0 +1,289 @@
+//  sha2_hkdf.c
+//  2020-03-13  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  HKDF with SHA2-256, SHA2-384, and SHA2-512 (RFC 5869). Expand takes the
+//  PRK as an HMAC key object, so the K ^ ipad and K ^ opad midstates are
+//  computed once per PRK and shared by every T(i) of every label.
+
+#include <stdlib.h>
+#include <string.h>
+#include "sha2_wrap.h"
+
+//  === Extract ===
+
+void hkdf_sha2_256_extract(uint8_t * prk, const void *salt, size_t saltlen,
+						   const void *ikm, size_t ikmlen)
+{
+	hmac_sha2_256(prk, salt, saltlen, ikm, ikmlen);
+}
+
+void hkdf_sha2_384_extract(uint8_t * prk, const void *salt, size_t saltlen,
+						   const void *ikm, size_t ikmlen)
+{
+	hmac_sha2_384(prk, salt, saltlen, ikm, ikmlen);
+}
+
+void hkdf_sha2_512_extract(uint8_t * prk, const void *salt, size_t saltlen,
+						   const void *ikm, size_t ikmlen)
+{
+	hmac_sha2_512(prk, salt, saltlen, ikm, ikmlen);
+}
+
+//  === Expand ===
+
+//  T(i) = HMAC(PRK, T(i - 1) | info | i) for i = 1, 2, ..
+
+int hkdf_sha2_256_expand(uint8_t * okm, size_t okmlen,
+						 const hmac_sha2_256_key_t * prk,
+						 const void *info, size_t infolen)
+{
+	size_t l, hl = prk->mdlen;
+	uint8_t i, t[32];
+	hmac_sha2_256_ctx_t h;
+
+	if (okmlen > 255 * hl)
+		return -1;
+
+	for (i = 1; okmlen > 0; i++) {
+		hmac_sha2_256_init(&h, prk);
+		if (i > 1)
+			hmac_sha2_256_update(&h, t, hl);
+		hmac_sha2_256_update(&h, info, infolen);
+		hmac_sha2_256_update(&h, &i, 1);
+		hmac_sha2_256_final(t, &h);
+		l = okmlen < hl ? okmlen : hl;
+		memcpy(okm, t, l);
+		okm += l;
+		okmlen -= l;
+	}
+
+	return 0;
+}
+
+int hkdf_sha2_512_expand(uint8_t * okm, size_t okmlen,
+						 const hmac_sha2_512_key_t * prk,
+						 const void *info, size_t infolen)
+{
+	size_t l, hl = prk->mdlen;
+	uint8_t i, t[64];
+	hmac_sha2_512_ctx_t h;
+
+	if (okmlen > 255 * hl)
+		return -1;
+
+	for (i = 1; okmlen > 0; i++) {
+		hmac_sha2_512_init(&h, prk);
+		if (i > 1)
+			hmac_sha2_512_update(&h, t, hl);
+		hmac_sha2_512_update(&h, info, infolen);
+		hmac_sha2_512_update(&h, &i, 1);
+		hmac_sha2_512_final(t, &h);
+		l = okmlen < hl ? okmlen : hl;
+		memcpy(okm, t, l);
+		okm += l;
+		okmlen -= l;
+	}
+
+	return 0;
+}
+
+//  === Batch expand ===
+
+//  Message k is kept as "T(i - 1) | info[k] | i" in one buffer, and T(i)
+//  is written over its first "hl" bytes. Step i is one HMAC batch over the
+//  labels that still need output.
+
+typedef struct {
+	size_t *off;							//  buffer offset of each label
+	size_t *len;							//  message lengths of a step
+	const uint8_t **in;						//  messages of a step
+	uint8_t **mac;							//  T(i) of a step
+	size_t *act;							//  labels in a step
+	uint8_t *buf;							//  all messages
+} hkdf_mb_t;
+
+static void hkdf_mb_free(hkdf_mb_t * w)
+{
+	free(w->off);
+	free(w->len);
+	free(w->in);
+	free(w->mac);
+	free(w->act);
+	free(w->buf);
+}
+
+//  check the lengths and allocate; returns 0 or -1
+
+static int hkdf_mb_alloc(hkdf_mb_t * w, size_t hl, const size_t okmlen[],
+						 const size_t infolen[], size_t n)
+{
+	size_t k, sz;
+
+	sz = 0;
+	for (k = 0; k < n; k++) {
+		if (okmlen[k] > 255 * hl)
+			return -1;
+		sz += hl + infolen[k] + 1;
+	}
+
+	w->off = malloc(n * sizeof(size_t));
+	w->len = malloc(n * sizeof(size_t));
+	w->in = malloc(n * sizeof(const uint8_t *));
+	w->mac = malloc(n * sizeof(uint8_t *));
+	w->act = malloc(n * sizeof(size_t));
+	w->buf = malloc(sz);
+	if (w->off == NULL || w->len == NULL || w->in == NULL ||
+		w->mac == NULL || w->act == NULL || w->buf == NULL) {
+		hkdf_mb_free(w);
+		return -1;
+	}
+
+	return 0;
+}
+
+//  set up step "i"; returns the number of labels in it
+
+static size_t hkdf_mb_step(hkdf_mb_t * w, size_t hl, int i,
+						   const size_t okmlen[],
+						   const uint8_t * const info[],
+						   const size_t infolen[], size_t n)
+{
+	size_t k, m;
+	uint8_t *p;
+
+	m = 0;
+	for (k = 0; k < n; k++) {
+		if (okmlen[k] <= (i - 1) * hl)
+			continue;
+		p = w->buf + w->off[k];
+		if (i == 1) {
+			memcpy(p + hl, info[k], infolen[k]);
+			w->in[m] = p + hl;
+			w->len[m] = infolen[k] + 1;
+		} else {
+			w->in[m] = p;
+			w->len[m] = hl + infolen[k] + 1;
+		}
+		p[hl + infolen[k]] = (uint8_t) i;
+		w->mac[m] = p;
+		w->act[m] = k;
+		m++;
+	}
+
+	return m;
+}
+
+//  copy T(i) of the labels in step "i" to their output
+
+static void hkdf_mb_out(hkdf_mb_t * w, size_t hl, int i, size_t m,
+						uint8_t * okm[], const size_t okmlen[])
+{
+	size_t j, k, l;
+
+	for (j = 0; j < m; j++) {
+		k = w->act[j];
+		l = okmlen[k] - (i - 1) * hl;
+		memcpy(okm[k] + (i - 1) * hl, w->mac[j], l < hl ? l : hl);
+	}
+}
+
+int hkdf_sha2_256_expand_batch(uint8_t * okm[], const size_t okmlen[],
+							   const hmac_sha2_256_key_t * prk,
+							   const uint8_t * const info[],
+							   const size_t infolen[], size_t n)
+{
+	size_t k, m, hl = prk->mdlen;
+	int i;
+	hkdf_mb_t w;
+
+	if (n == 0)
+		return 0;
+	if (hkdf_mb_alloc(&w, hl, okmlen, infolen, n))
+		return -1;
+	for (k = 0, m = 0; k < n; k++) {
+		w.off[k] = m;
+		m += hl + infolen[k] + 1;
+	}
+
+	for (i = 1; (m = hkdf_mb_step(&w, hl, i, okmlen, info, infolen, n)) > 0;
+		 i++) {
+		hmac_sha2_256_batch(w.mac, prk, w.in, w.len, m);
+		hkdf_mb_out(&w, hl, i, m, okm, okmlen);
+	}
+	hkdf_mb_free(&w);
+
+	return 0;
+}
+
+int hkdf_sha2_512_expand_batch(uint8_t * okm[], const size_t okmlen[],
+							   const hmac_sha2_512_key_t * prk,
+							   const uint8_t * const info[],
+							   const size_t infolen[], size_t n)
+{
+	size_t k, m, hl = prk->mdlen;
+	int i;
+	hkdf_mb_t w;
+
+	if (n == 0)
+		return 0;
+	if (hkdf_mb_alloc(&w, hl, okmlen, infolen, n))
+		return -1;
+	for (k = 0, m = 0; k < n; k++) {
+		w.off[k] = m;
+		m += hl + infolen[k] + 1;
+	}
+
+	for (i = 1; (m = hkdf_mb_step(&w, hl, i, okmlen, info, infolen, n)) > 0;
+		 i++) {
+		hmac_sha2_512_batch(w.mac, prk, w.in, w.len, m);
+		hkdf_mb_out(&w, hl, i, m, okm, okmlen);
+	}
+	hkdf_mb_free(&w);
+
+	return 0;
+}
+
+//  === Extract and expand ===
+
+int hkdf_sha2_256(uint8_t * okm, size_t okmlen,
+				  const void *salt, size_t saltlen,
+				  const void *ikm, size_t ikmlen,
+				  const void *info, size_t infolen)
+{
+	uint8_t prk[32];
+	hmac_sha2_256_key_t key;
+
+	hkdf_sha2_256_extract(prk, salt, saltlen, ikm, ikmlen);
+	hmac_sha2_256_key(&key, prk, 32);
+
+	return hkdf_sha2_256_expand(okm, okmlen, &key, info, infolen);
+}
+
+int hkdf_sha2_384(uint8_t * okm, size_t okmlen,
+				  const void *salt, size_t saltlen,
+				  const void *ikm, size_t ikmlen,
+				  const void *info, size_t infolen)
+{
+	uint8_t prk[48];
+	hmac_sha2_512_key_t key;
+
+	hkdf_sha2_384_extract(prk, salt, saltlen, ikm, ikmlen);
+	hmac_sha2_384_key(&key, prk, 48);
+
+	return hkdf_sha2_512_expand(okm, okmlen, &key, info, infolen);
+}
+
+int hkdf_sha2_512(uint8_t * okm, size_t okmlen,
+				  const void *salt, size_t saltlen,
+				  const void *ikm, size_t ikmlen,
+				  const void *info, size_t infolen)
+{
+	uint8_t prk[64];
+	hmac_sha2_512_key_t key;
+
+	hkdf_sha2_512_extract(prk, salt, saltlen, ikm, ikmlen);
+	hmac_sha2_512_key(&key, prk, 64);
+
+	return hkdf_sha2_512_expand(okm, okmlen, &key, info, infolen);
+}
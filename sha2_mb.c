@@ -0,0 +1,271 @@
+//  sha2_mb.c
+//  2020-03-12  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  Multi-buffer SHA2-256 and SHA2-512 front end. Each lane of a lane kernel
+//  hashes a different message; the front end pads the last blocks of each
+//  message in a per-lane buffer, gives every lane a pointer to its next
+//  block, and masks out lanes that have nothing to do. A lane that
+//  finishes is refilled with the next message at once, so short and long
+//  messages can be mixed.
+
+#include <string.h>
+#include "sha2_wrap.h"
+#include "rv_endian.h"
+
+//  the widest lane kernel available at compile time
+
+#if defined(__AVX512F__)
+int sha256_mb_lanes = 16;
+void (*sha256_mb)(uint32_t *, const uint8_t * const *, uint32_t) =
+	&avx512_sha256_x16;
+int sha512_mb_lanes = 8;
+void (*sha512_mb)(uint64_t *, const uint8_t * const *, uint32_t) =
+	&avx512_sha512_x8;
+#elif defined(__AVX2__)
+int sha256_mb_lanes = 8;
+void (*sha256_mb)(uint32_t *, const uint8_t * const *, uint32_t) =
+	&avx2_sha256_x8;
+int sha512_mb_lanes = 4;
+void (*sha512_mb)(uint64_t *, const uint8_t * const *, uint32_t) =
+	&avx2_sha512_x4;
+#else
+int sha256_mb_lanes = 8;
+void (*sha256_mb)(uint32_t *, const uint8_t * const *, uint32_t) =
+	&c_sha256_x8;
+int sha512_mb_lanes = 4;
+void (*sha512_mb)(uint64_t *, const uint8_t * const *, uint32_t) =
+	&c_sha512_x4;
+#endif
+
+//  a readable block for idle lanes
+
+static const uint8_t mb_zero[128] = { 0 };
+
+//  portable lane kernels: one lane at a time through sha256_blocks
+
+void c_sha256_x8(uint32_t * s, const uint8_t * const blk[], uint32_t mask)
+{
+	int i, j;
+	uint32_t v[8];
+
+	for (j = 0; j < 8; j++) {
+		if (((mask >> j) & 1) == 0)
+			continue;
+		for (i = 0; i < 8; i++)
+			v[i] = s[8 * i + j];
+		sha256_blocks(v, blk[j], 1);
+		for (i = 0; i < 8; i++)
+			s[8 * i + j] = v[i];
+	}
+}
+
+void c_sha512_x4(uint64_t * s, const uint8_t * const blk[], uint32_t mask)
+{
+	int i, j;
+	uint64_t v[8];
+
+	for (j = 0; j < 4; j++) {
+		if (((mask >> j) & 1) == 0)
+			continue;
+		for (i = 0; i < 8; i++)
+			v[i] = s[4 * i + j];
+		sha512_blocks(v, blk[j], 1);
+		for (i = 0; i < 8; i++)
+			s[4 * i + j] = v[i];
+	}
+}
+
+//  "n" messages from chaining value "iv" after "pre" bytes (the length
+//  field counts them) to 32-byte md[i]
+
+static void mb256(uint8_t * md[], const uint8_t * const in[],
+				  const size_t len[], size_t n,
+				  const uint32_t iv[8], size_t pre)
+{
+	int i, j, lanes;
+	size_t next, r, msg[SHA2_MB_MAX], blk[SHA2_MB_MAX];
+	size_t full[SHA2_MB_MAX], nblk[SHA2_MB_MAX];
+	uint32_t mask, s[8 * SHA2_MB_MAX];
+	uint8_t tb[SHA2_MB_MAX][128];
+	const uint8_t *bp[SHA2_MB_MAX];
+
+	lanes = sha256_mb_lanes;
+	mask = 0;
+	next = 0;
+
+	while (1) {
+
+		for (j = 0; j < lanes && next < n; j++) {	//  refill idle lanes
+			if ((mask >> j) & 1)
+				continue;
+			msg[j] = next++;
+			blk[j] = 0;
+			full[j] = len[msg[j]] / 64;
+			r = len[msg[j]] % 64;
+			memcpy(tb[j], in[msg[j]] + 64 * full[j], r);
+			tb[j][r++] = 0x80;
+			nblk[j] = full[j] + (r > 56 ? 2 : 1);
+			memset(tb[j] + r, 0x00, 128 - r);
+			put64u_be(tb[j] + 64 * (nblk[j] - full[j]) - 8,
+					  (pre + len[msg[j]]) << 3);
+			for (i = 0; i < 8; i++)
+				s[lanes * i + j] = iv[i];
+			mask |= 1u << j;
+		}
+		if (mask == 0)
+			break;
+
+		for (j = 0; j < lanes; j++) {		//  next block of each lane
+			if (((mask >> j) & 1) == 0)
+				bp[j] = mb_zero;
+			else if (blk[j] < full[j])
+				bp[j] = in[msg[j]] + 64 * blk[j];
+			else
+				bp[j] = tb[j] + 64 * (blk[j] - full[j]);
+		}
+
+		sha256_mb(s, bp, mask);
+
+		for (j = 0; j < lanes; j++) {		//  output finished lanes
+			if (((mask >> j) & 1) == 0 || ++blk[j] < nblk[j])
+				continue;
+			for (i = 0; i < 8; i++)
+				put32u_be(md[msg[j]] + 4 * i, s[lanes * i + j]);
+			mask &= ~(1u << j);
+		}
+	}
+}
+
+//  .. and "n" messages from "iv" after "pre" bytes to 64-byte md[i]
+
+static void mb512(uint8_t * md[], const uint8_t * const in[],
+				  const size_t len[], size_t n,
+				  const uint64_t iv[8], size_t pre)
+{
+	int i, j, lanes;
+	size_t next, r, msg[SHA2_MB_MAX], blk[SHA2_MB_MAX];
+	size_t full[SHA2_MB_MAX], nblk[SHA2_MB_MAX];
+	uint32_t mask;
+	uint64_t s[8 * SHA2_MB_MAX];
+	uint8_t tb[SHA2_MB_MAX][256];
+	const uint8_t *bp[SHA2_MB_MAX];
+
+	lanes = sha512_mb_lanes;
+	mask = 0;
+	next = 0;
+
+	while (1) {
+
+		for (j = 0; j < lanes && next < n; j++) {	//  refill idle lanes
+			if ((mask >> j) & 1)
+				continue;
+			msg[j] = next++;
+			blk[j] = 0;
+			full[j] = len[msg[j]] / 128;
+			r = len[msg[j]] % 128;
+			memcpy(tb[j], in[msg[j]] + 128 * full[j], r);
+			tb[j][r++] = 0x80;
+			nblk[j] = full[j] + (r > 112 ? 2 : 1);
+			memset(tb[j] + r, 0x00, 256 - r);
+			r = 128 * (nblk[j] - full[j]);
+			put64u_be(tb[j] + r - 16, (pre + len[msg[j]]) >> 61);
+			put64u_be(tb[j] + r - 8, (pre + len[msg[j]]) << 3);
+			for (i = 0; i < 8; i++)
+				s[lanes * i + j] = iv[i];
+			mask |= 1u << j;
+		}
+		if (mask == 0)
+			break;
+
+		for (j = 0; j < lanes; j++) {		//  next block of each lane
+			if (((mask >> j) & 1) == 0)
+				bp[j] = mb_zero;
+			else if (blk[j] < full[j])
+				bp[j] = in[msg[j]] + 128 * blk[j];
+			else
+				bp[j] = tb[j] + 128 * (blk[j] - full[j]);
+		}
+
+		sha512_mb(s, bp, mask);
+
+		for (j = 0; j < lanes; j++) {		//  output finished lanes
+			if (((mask >> j) & 1) == 0 || ++blk[j] < nblk[j])
+				continue;
+			for (i = 0; i < 8; i++)
+				put64u_be(md[msg[j]] + 8 * i, s[lanes * i + j]);
+			mask &= ~(1u << j);
+		}
+	}
+}
+
+//  SHA2-256 and SHA2-512 of "n" messages
+
+void sha2_256_batch(uint8_t * md[], const uint8_t * const in[],
+					const size_t len[], size_t n)
+{
+	mb256(md, in, len, n, sha2_256_h0, 0);
+}
+
+void sha2_512_batch(uint8_t * md[], const uint8_t * const in[],
+					const size_t len[], size_t n)
+{
+	mb512(md, in, len, n, sha2_512_h0, 0);
+}
+
+//  HMAC of "n" messages under one key object, in groups of HMAC_MB: all
+//  inner hashes of a group from the K ^ ipad midstate, then all outer
+//  hashes from the K ^ opad midstate. A group has read its messages
+//  before its MACs are written, so mac[i] may overlap in[i].
+
+#define HMAC_MB 64
+
+void hmac_sha2_256_batch(uint8_t * mac[], const hmac_sha2_256_key_t * key,
+						 const uint8_t * const in[], const size_t len[],
+						 size_t n)
+{
+	size_t i, m, tl[HMAC_MB];
+	uint8_t t[HMAC_MB][32], u[HMAC_MB][32], *tp[HMAC_MB], *up[HMAC_MB];
+
+	for (i = 0; i < HMAC_MB; i++) {
+		tp[i] = t[i];
+		up[i] = u[i];
+		tl[i] = key->mdlen;
+	}
+
+	for (; n > 0; n -= m) {
+		m = n < HMAC_MB ? n : HMAC_MB;
+		mb256(tp, in, len, m, key->hi, 64);
+		mb256(up, (const uint8_t * const *) tp, tl, m, key->ho, 64);
+		for (i = 0; i < m; i++)
+			memcpy(mac[i], u[i], key->mdlen);
+		mac += m;
+		in += m;
+		len += m;
+	}
+}
+
+void hmac_sha2_512_batch(uint8_t * mac[], const hmac_sha2_512_key_t * key,
+						 const uint8_t * const in[], const size_t len[],
+						 size_t n)
+{
+	size_t i, m, tl[HMAC_MB];
+	uint8_t t[HMAC_MB][64], u[HMAC_MB][64], *tp[HMAC_MB], *up[HMAC_MB];
+
+	for (i = 0; i < HMAC_MB; i++) {
+		tp[i] = t[i];
+		up[i] = u[i];
+		tl[i] = key->mdlen;
+	}
+
+	for (; n > 0; n -= m) {
+		m = n < HMAC_MB ? n : HMAC_MB;
+		mb512(tp, in, len, m, key->hi, 128);
+		mb512(up, (const uint8_t * const *) tp, tl, m, key->ho, 128);
+		for (i = 0; i < m; i++)
+			memcpy(mac[i], u[i], key->mdlen);
+		mac += m;
+		in += m;
+		len += m;
+	}
+}
@@ -0,0 +1,230 @@
+//  sha2_node256.c
+//  2020-03-08  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  SHA2-256 and double SHA2-256 of exactly 64 bytes (Merkle tree nodes).
+//  The second block is always the same padding block, so its message
+//  schedule plus round constants W[t] + K[t] is a constant table.
+
+#include <string.h>
+#include "sha2_wrap.h"
+#include "rv_endian.h"
+
+//  W[t] + K[t] for the padding block of a 64-byte message
+
+static const uint32_t sha256_pad64_wk[64] = {
+	0xC28A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+	0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+	0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+	0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF374,
+	0x649B69C1, 0xF0FE4786, 0x0FE1EDC6, 0x240CF254,
+	0x4FE9346F, 0x6CC984BE, 0x61B9411E, 0x16F988FA,
+	0xF2C65152, 0xA88E5A6D, 0xB019FC65, 0xB9D99EC7,
+	0x9A1231C3, 0xE70EEAA0, 0xFDB1232B, 0xC7353EB0,
+	0x3069BAD5, 0xCB976D5F, 0x5A0F118F, 0xDC1EEEFD,
+	0x0A35B689, 0xDE0B7A04, 0x58F4CA9D, 0xE15D5B16,
+	0x007F3E86, 0x37088980, 0xA507EA32, 0x6FAB9537,
+	0x17406110, 0x0D8CD6F1, 0xCDAA3B6D, 0xC0BBBE37,
+	0x83613BDA, 0xDB48A363, 0x0B02E931, 0x6FD15CA7,
+	0x521AFACA, 0x31338431, 0x6ED41A95, 0x6D437890,
+	0xC39C91F2, 0x9ECCABBD, 0xB5C9A0E6, 0x532FB63C,
+	0xD2C741C6, 0x07237EA3, 0xA4954B68, 0x4C191D76
+};
+
+//  64 rounds with a ready W[t] + K[t], including the feed-forward
+
+static void sha256wk(uint32_t v[8], const uint32_t wk[64])
+{
+	int t;
+	uint32_t a, b, c, d, e, f, g, h, x;
+
+	a = v[0];
+	b = v[1];
+	c = v[2];
+	d = v[3];
+	e = v[4];
+	f = v[5];
+	g = v[6];
+	h = v[7];
+
+	for (t = 0; t < 64; t++) {
+		x = h + sha256_sum1(e) + (g ^ (e & (f ^ g))) + wk[t];
+		h = g;
+		g = f;
+		f = e;
+		e = d + x;
+		d = c;
+		c = b;
+		b = a;
+		a = x + sha256_sum0(b) + (((b | d) & c) | (d & b));
+	}
+
+	v[0] += a;
+	v[1] += b;
+	v[2] += c;
+	v[3] += d;
+	v[4] += e;
+	v[5] += f;
+	v[6] += g;
+	v[7] += h;
+}
+
+//  state words after SHA2-256 of 64 bytes: data block and constant block
+
+static void sha256_64w(uint32_t v[8], const uint8_t * in)
+{
+	int i;
+
+	for (i = 0; i < 8; i++)
+		v[i] = sha2_256_h0[i];
+	sha256_blocks(v, in, 1);
+	sha256wk(v, sha256_pad64_wk);
+}
+
+//  Compute 32-byte SHA2-256 hash to "md" from 64 bytes at "in"
+
+void sha256_64B(uint8_t * md, const uint8_t * in)
+{
+	int i;
+	uint32_t v[8];
+
+	sha256_64w(v, in);
+	for (i = 0; i < 8; i++)
+		put32u_be(&md[i << 2], v[i]);
+}
+
+//  W[t] + K[t] for words 8..15 of the second hash of sha256d_64B(), which
+//  are its padding: 0x80000000, six zeros, and the length 256
+
+static const uint32_t sha256d_pad_wk[8] = {
+	0x5807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+	0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF274
+};
+
+//  Compute 32-byte SHA2-256(SHA2-256(in)) to "md" from 64 bytes at "in".
+//  The second hash has a single block with words 8..15 fixed. Their terms
+//  of W[16..31] are folded into the constants below (most are zero), and
+//  W[8..15] + K[8..15] is a table: 267 schedule and K ops instead of 304.
+
+void sha256d_64B(uint8_t * md, const uint8_t * in)
+{
+	int t;
+	uint32_t v[8], w[64];
+
+	sha256_64w(w, in);						//  W[0..7] is the first hash
+
+	w[16] = sha256_sig0(w[1]) + w[0];
+	w[17] = sha256_sig0(w[2]) + w[1] + 0x00A00000;
+	for (t = 18; t < 22; t++)
+		w[t] = sha256_sig1(w[t - 2]) + sha256_sig0(w[t - 15]) + w[t - 16];
+	w[22] = sha256_sig1(w[20]) + sha256_sig0(w[7]) + w[6] + 0x00000100;
+	w[23] = sha256_sig1(w[21]) + w[16] + w[7] + 0x11002000;
+	w[24] = sha256_sig1(w[22]) + w[17] + 0x80000000;
+	for (t = 25; t < 30; t++)
+		w[t] = sha256_sig1(w[t - 2]) + w[t - 7];
+	w[30] = sha256_sig1(w[28]) + w[23] + 0x00400022;
+	w[31] = sha256_sig1(w[29]) + w[24] + sha256_sig0(w[16]) + 0x00000100;
+	for (t = 32; t < 64; t++)
+		w[t] = sha256_sig1(w[t - 2]) + w[t - 7] +
+			sha256_sig0(w[t - 15]) + w[t - 16];
+
+	for (t = 0; t < 8; t++) {
+		w[t] += sha256_k[t];
+		w[t + 8] = sha256d_pad_wk[t];
+	}
+	for (t = 16; t < 64; t++)
+		w[t] += sha256_k[t];
+
+	for (t = 0; t < 8; t++)
+		v[t] = sha2_256_h0[t];
+	sha256wk(v, w);
+
+	for (t = 0; t < 8; t++)
+		put32u_be(&md[t << 2], v[t]);
+}
+
+//  the padding block of a 64-byte message
+
+static const uint8_t sha256_pad64[64] = {
+	0x80, [62] = 0x02
+};
+
+//  "n" consecutive 64-byte inputs to "n" consecutive 32-byte hashes in the
+//  lanes of sha256_mb; a level of a Merkle tree is one call. The data
+//  blocks are read in place and all lanes share the padding block. "md"
+//  may overlap the start of "in".
+
+static uint32_t sha256_64B_mb(uint32_t * s, const uint8_t * in,
+							  size_t q, size_t n, int lanes)
+{
+	int i, j;
+	uint32_t mask;
+	const uint8_t *bp[SHA2_MB_MAX], *pp[SHA2_MB_MAX];
+
+	mask = 0;
+	for (j = 0; j < lanes; j++) {
+		pp[j] = sha256_pad64;
+		if (q + j < n) {
+			bp[j] = in + 64 * (q + j);
+			mask |= 1u << j;
+		} else {
+			bp[j] = sha256_pad64;			//  idle lane
+		}
+		for (i = 0; i < 8; i++)
+			s[lanes * i + j] = sha2_256_h0[i];
+	}
+	sha256_mb(s, bp, mask);
+	sha256_mb(s, pp, mask);
+
+	return mask;
+}
+
+void sha256_64B_x(uint8_t * md, const uint8_t * in, size_t n)
+{
+	int i, j, lanes;
+	size_t q;
+	uint32_t s[8 * SHA2_MB_MAX];
+
+	lanes = sha256_mb_lanes;
+	for (q = 0; q < n; q += lanes) {
+		sha256_64B_mb(s, in, q, n, lanes);
+		for (j = 0; j < lanes && q + j < n; j++) {
+			for (i = 0; i < 8; i++)
+				put32u_be(md + 32 * (q + j) + 4 * i, s[lanes * i + j]);
+		}
+	}
+}
+
+//  .. and the second hash from per-lane blocks with the padding set once
+
+void sha256d_64B_x(uint8_t * md, const uint8_t * in, size_t n)
+{
+	int i, j, lanes;
+	size_t q;
+	uint32_t mask, s[8 * SHA2_MB_MAX];
+	uint8_t tb[SHA2_MB_MAX][64];
+	const uint8_t *bp[SHA2_MB_MAX];
+
+	lanes = sha256_mb_lanes;
+	for (j = 0; j < lanes; j++) {
+		memset(tb[j], 0x00, 64);
+		tb[j][32] = 0x80;
+		tb[j][62] = 0x01;					//  256 bits
+		bp[j] = tb[j];
+	}
+
+	for (q = 0; q < n; q += lanes) {
+		mask = sha256_64B_mb(s, in, q, n, lanes);
+		for (j = 0; j < lanes; j++) {
+			for (i = 0; i < 8; i++) {
+				put32u_be(tb[j] + 4 * i, s[lanes * i + j]);
+				s[lanes * i + j] = sha2_256_h0[i];
+			}
+		}
+		sha256_mb(s, bp, mask);
+		for (j = 0; j < lanes && q + j < n; j++) {
+			for (i = 0; i < 8; i++)
+				put32u_be(md + 32 * (q + j) + 4 * i, s[lanes * i + j]);
+		}
+	}
+}
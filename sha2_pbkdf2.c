@@ -0,0 +1,349 @@
+//  sha2_pbkdf2.c
+//  2020-03-13  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  PBKDF2-HMAC-SHA2-256 and PBKDF2-HMAC-SHA2-512 (RFC 8018, Sect. 5.2).
+//  The password is set up once as an HMAC key object, so each iteration
+//  U_j = HMAC(P, U_{j-1}) is exactly two compressions: the inner one from
+//  the K ^ ipad midstate over "U_{j-1} | padding", and the outer one from
+//  the K ^ opad midstate over "inner hash | padding". The padding of both
+//  blocks is the same and is set up once. The batch versions run one
+//  (password, output block) pair in each lane of the multi-buffer kernel.
+
+#include <string.h>
+#include "sha2_wrap.h"
+#include "rv_endian.h"
+
+//  RFC 8018 Sect. 5.2 step 1: at most 2^32 - 1 blocks, as the block index
+//  INT(i) is 32 bits
+
+#define PBKDF2_MAX_BLOCKS ((uint64_t) 0xFFFFFFFF)
+
+//  the padding of a 32-byte message after a 64-byte key block
+
+static void pad256(uint8_t b[64])
+{
+	b[32] = 0x80;
+	memset(b + 33, 0x00, 56 - 33);
+	put64u_be(b + 56, (64 + 32) << 3);
+}
+
+//  .. and of a 64-byte message after a 128-byte key block
+
+static void pad512(uint8_t b[128])
+{
+	b[64] = 0x80;
+	memset(b + 65, 0x00, 120 - 65);
+	put64u_be(b + 120, (128 + 64) << 3);
+}
+
+//  U_1 = HMAC(P, S | INT(i)) to "b", followed by padding
+
+static void pbkdf2_256_u1(uint8_t b[64], const hmac_sha2_256_key_t * key,
+						  const void *salt, size_t saltlen, uint32_t i)
+{
+	hmac_sha2_256_ctx_t h;
+	uint8_t ib[4];
+
+	put32u_be(ib, i);
+	hmac_sha2_256_init(&h, key);
+	hmac_sha2_256_update(&h, salt, saltlen);
+	hmac_sha2_256_update(&h, ib, 4);
+	hmac_sha2_256_final(b, &h);
+	pad256(b);
+}
+
+static void pbkdf2_512_u1(uint8_t b[128], const hmac_sha2_512_key_t * key,
+						  const void *salt, size_t saltlen, uint32_t i)
+{
+	hmac_sha2_512_ctx_t h;
+	uint8_t ib[4];
+
+	put32u_be(ib, i);
+	hmac_sha2_512_init(&h, key);
+	hmac_sha2_512_update(&h, salt, saltlen);
+	hmac_sha2_512_update(&h, ib, 4);
+	hmac_sha2_512_final(b, &h);
+	pad512(b);
+}
+
+//  === One lane ===
+
+//  T_i = U_1 ^ U_2 ^ .. ^ U_c as bytes to "t"
+
+static void pbkdf2_256_t(uint8_t t[32], const hmac_sha2_256_key_t * key,
+						 const void *salt, size_t saltlen,
+						 uint32_t i, uint32_t c)
+{
+	int k;
+	uint32_t u[8], x[8];
+	uint8_t b[64];
+
+	pbkdf2_256_u1(b, key, salt, saltlen, i);
+	for (k = 0; k < 8; k++)
+		x[k] = get32u_be(b + 4 * k);
+
+	for (; c > 1; c--) {
+		for (k = 0; k < 8; k++)
+			u[k] = key->hi[k];
+		sha256_blocks(u, b, 1);				//  inner hash
+		for (k = 0; k < 8; k++) {
+			put32u_be(b + 4 * k, u[k]);
+			u[k] = key->ho[k];
+		}
+		sha256_blocks(u, b, 1);				//  outer hash
+		for (k = 0; k < 8; k++) {
+			put32u_be(b + 4 * k, u[k]);
+			x[k] ^= u[k];
+		}
+	}
+
+	for (k = 0; k < 8; k++)
+		put32u_be(t + 4 * k, x[k]);
+}
+
+static void pbkdf2_512_t(uint8_t t[64], const hmac_sha2_512_key_t * key,
+						 const void *salt, size_t saltlen,
+						 uint32_t i, uint32_t c)
+{
+	int k;
+	uint64_t u[8], x[8];
+	uint8_t b[128];
+
+	pbkdf2_512_u1(b, key, salt, saltlen, i);
+	for (k = 0; k < 8; k++)
+		x[k] = get64u_be(b + 8 * k);
+
+	for (; c > 1; c--) {
+		for (k = 0; k < 8; k++)
+			u[k] = key->hi[k];
+		sha512_blocks(u, b, 1);				//  inner hash
+		for (k = 0; k < 8; k++) {
+			put64u_be(b + 8 * k, u[k]);
+			u[k] = key->ho[k];
+		}
+		sha512_blocks(u, b, 1);				//  outer hash
+		for (k = 0; k < 8; k++) {
+			put64u_be(b + 8 * k, u[k]);
+			x[k] ^= u[k];
+		}
+	}
+
+	for (k = 0; k < 8; k++)
+		put64u_be(t + 8 * k, x[k]);
+}
+
+//  derive "dklen" bytes to "dk" with "c" iterations
+
+int pbkdf2_sha2_256(uint8_t * dk, size_t dklen,
+					const void *pw, size_t pwlen,
+					const void *salt, size_t saltlen, uint32_t c)
+{
+	uint32_t i;
+	size_t l;
+	uint8_t t[32];
+	hmac_sha2_256_key_t key;
+
+	if ((uint64_t) dklen > PBKDF2_MAX_BLOCKS * 32)
+		return -1;
+	hmac_sha2_256_key(&key, pw, pwlen);
+
+	for (i = 1; dklen > 0; i++) {
+		pbkdf2_256_t(t, &key, salt, saltlen, i, c);
+		l = dklen < 32 ? dklen : 32;
+		memcpy(dk, t, l);
+		dk += l;
+		dklen -= l;
+	}
+
+	return 0;
+}
+
+int pbkdf2_sha2_512(uint8_t * dk, size_t dklen,
+					const void *pw, size_t pwlen,
+					const void *salt, size_t saltlen, uint32_t c)
+{
+	uint32_t i;
+	size_t l;
+	uint8_t t[64];
+	hmac_sha2_512_key_t key;
+
+	if ((uint64_t) dklen > PBKDF2_MAX_BLOCKS * 64)
+		return -1;
+	hmac_sha2_512_key(&key, pw, pwlen);
+
+	for (i = 1; dklen > 0; i++) {
+		pbkdf2_512_t(t, &key, salt, saltlen, i, c);
+		l = dklen < 64 ? dklen : 64;
+		memcpy(dk, t, l);
+		dk += l;
+		dklen -= l;
+	}
+
+	return 0;
+}
+
+//  === Multi-buffer ===
+
+//  "n" passwords with their salts; job q is block (q % nb) + 1 of password
+//  q / nb. All jobs have "c" iterations, so a group of jobs stays in the
+//  lanes until it is done.
+
+int pbkdf2_sha2_256_batch(uint8_t * dk[], size_t dklen,
+						  const uint8_t * const pw[], const size_t pwlen[],
+						  const uint8_t * const salt[],
+						  const size_t saltlen[], uint32_t c, size_t n)
+{
+	int j, k, lanes;
+	size_t q, p, pp, nb, jobs, l;
+	uint32_t i, mask, s[8 * SHA2_MB_MAX], x[8 * SHA2_MB_MAX];
+	uint8_t tb[SHA2_MB_MAX][64];
+	const uint8_t *bp[SHA2_MB_MAX];
+	hmac_sha2_256_key_t pk, key[SHA2_MB_MAX];
+
+	if ((uint64_t) dklen > PBKDF2_MAX_BLOCKS * 32)
+		return -1;
+	lanes = sha256_mb_lanes;
+	nb = (dklen + 31) / 32;
+	pp = n;
+	jobs = n * nb;
+	memset(s, 0, sizeof(s));
+	memset(tb, 0, sizeof(tb));
+
+	for (q = 0; q < jobs; q += lanes) {
+
+		mask = 0;							//  key setup and U_1
+		for (j = 0; j < lanes && q + j < jobs; j++) {
+			p = (q + j) / nb;
+			if (p != pp) {					//  once per password
+				hmac_sha2_256_key(&pk, pw[p], pwlen[p]);
+				pp = p;
+			}
+			key[j] = pk;
+			pbkdf2_256_u1(tb[j], &key[j], salt[p], saltlen[p],
+						  (q + j) % nb + 1);
+			for (k = 0; k < 8; k++)
+				x[lanes * k + j] = get32u_be(tb[j] + 4 * k);
+			mask |= 1u << j;
+		}
+		for (j = 0; j < lanes; j++)
+			bp[j] = tb[j];
+
+		for (i = 1; i < c; i++) {
+			for (j = 0; j < lanes; j++) {
+				if ((mask >> j) & 1) {
+					for (k = 0; k < 8; k++)
+						s[lanes * k + j] = key[j].hi[k];
+				}
+			}
+			sha256_mb(s, bp, mask);			//  inner hashes
+			for (j = 0; j < lanes; j++) {
+				if ((mask >> j) & 1) {
+					for (k = 0; k < 8; k++) {
+						put32u_be(tb[j] + 4 * k, s[lanes * k + j]);
+						s[lanes * k + j] = key[j].ho[k];
+					}
+				}
+			}
+			sha256_mb(s, bp, mask);			//  outer hashes
+			for (j = 0; j < lanes; j++) {
+				if ((mask >> j) & 1) {
+					for (k = 0; k < 8; k++) {
+						put32u_be(tb[j] + 4 * k, s[lanes * k + j]);
+						x[lanes * k + j] ^= s[lanes * k + j];
+					}
+				}
+			}
+		}
+
+		for (j = 0; j < lanes && q + j < jobs; j++) {
+			for (k = 0; k < 8; k++)
+				put32u_be(tb[j] + 4 * k, x[lanes * k + j]);
+			p = 32 * ((q + j) % nb);
+			l = dklen - p < 32 ? dklen - p : 32;
+			memcpy(dk[(q + j) / nb] + p, tb[j], l);
+		}
+	}
+
+	return 0;
+}
+
+int pbkdf2_sha2_512_batch(uint8_t * dk[], size_t dklen,
+						  const uint8_t * const pw[], const size_t pwlen[],
+						  const uint8_t * const salt[],
+						  const size_t saltlen[], uint32_t c, size_t n)
+{
+	int j, k, lanes;
+	size_t q, p, pp, nb, jobs, l;
+	uint32_t i, mask;
+	uint64_t s[8 * SHA2_MB_MAX], x[8 * SHA2_MB_MAX];
+	uint8_t tb[SHA2_MB_MAX][128];
+	const uint8_t *bp[SHA2_MB_MAX];
+	hmac_sha2_512_key_t pk, key[SHA2_MB_MAX];
+
+	if ((uint64_t) dklen > PBKDF2_MAX_BLOCKS * 64)
+		return -1;
+	lanes = sha512_mb_lanes;
+	nb = (dklen + 63) / 64;
+	pp = n;
+	jobs = n * nb;
+	memset(s, 0, sizeof(s));
+	memset(tb, 0, sizeof(tb));
+
+	for (q = 0; q < jobs; q += lanes) {
+
+		mask = 0;							//  key setup and U_1
+		for (j = 0; j < lanes && q + j < jobs; j++) {
+			p = (q + j) / nb;
+			if (p != pp) {					//  once per password
+				hmac_sha2_512_key(&pk, pw[p], pwlen[p]);
+				pp = p;
+			}
+			key[j] = pk;
+			pbkdf2_512_u1(tb[j], &key[j], salt[p], saltlen[p],
+						  (q + j) % nb + 1);
+			for (k = 0; k < 8; k++)
+				x[lanes * k + j] = get64u_be(tb[j] + 8 * k);
+			mask |= 1u << j;
+		}
+		for (j = 0; j < lanes; j++)
+			bp[j] = tb[j];
+
+		for (i = 1; i < c; i++) {
+			for (j = 0; j < lanes; j++) {
+				if ((mask >> j) & 1) {
+					for (k = 0; k < 8; k++)
+						s[lanes * k + j] = key[j].hi[k];
+				}
+			}
+			sha512_mb(s, bp, mask);			//  inner hashes
+			for (j = 0; j < lanes; j++) {
+				if ((mask >> j) & 1) {
+					for (k = 0; k < 8; k++) {
+						put64u_be(tb[j] + 8 * k, s[lanes * k + j]);
+						s[lanes * k + j] = key[j].ho[k];
+					}
+				}
+			}
+			sha512_mb(s, bp, mask);			//  outer hashes
+			for (j = 0; j < lanes; j++) {
+				if ((mask >> j) & 1) {
+					for (k = 0; k < 8; k++) {
+						put64u_be(tb[j] + 8 * k, s[lanes * k + j]);
+						x[lanes * k + j] ^= s[lanes * k + j];
+					}
+				}
+			}
+		}
+
+		for (j = 0; j < lanes && q + j < jobs; j++) {
+			for (k = 0; k < 8; k++)
+				put64u_be(tb[j] + 8 * k, x[lanes * k + j]);
+			p = 64 * ((q + j) % nb);
+			l = dklen - p < 64 ? dklen - p : 64;
+			memcpy(dk[(q + j) / nb] + p, tb[j], l);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,156 @@
+//  sha2_rv32_cf256x2.c
+//  2020-03-13  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  FIPS 180-4 SHA2-224/256 compression of two independent messages in one
+//  instruction stream ("stitching"). A round is a serial chain through h,
+//  so a superscalar core has idle issue slots; the rounds of the second
+//  message fill them. Both states and schedules are live at once: 8
+//  state and 16 message words per message, 48 for the two, do not fit 31
+//  registers, so the message words spill on RV32/RV64 (x86-64 spills
+//  more).
+
+#include "sha2_wrap.h"
+#include "rv_endian.h"
+
+//  round and schedule step pairs; names get 0 or 1 appended
+
+#define SHA256R(a, b, c, d, e, f, g, h, mi, ki) {	\
+	h = h + (g ^ (e & (f ^ g))) + mi + ki;			\
+	h = h + sha256_sum1(e);							\
+	d = d + h;										\
+	h = h + sha256_sum0(a);							\
+	h = h + (((a | c) & b) | (c & a));				}
+
+#define SHA256R2(a, b, c, d, e, f, g, h, i) {			\
+	SHA256R(a##0, b##0, c##0, d##0, e##0, f##0, g##0, h##0,	\
+		m0[i], kp[i]);										\
+	SHA256R(a##1, b##1, c##1, d##1, e##1, f##1, g##1, h##1,	\
+		m1[i], kp[i]);										}
+
+#define SHA256K(x0, x1, x9, xe) {	\
+	x0 = x0 + x9;					\
+	x0 = x0 + sha256_sig0(x1);		\
+	x0 = x0 + sha256_sig1(xe);		}
+
+#define SHA256K2(i) {												\
+	SHA256K(m0[i], m0[(i + 1) & 15], m0[(i + 9) & 15], m0[(i + 14) & 15]); \
+	SHA256K(m1[i], m1[(i + 1) & 15], m1[(i + 9) & 15], m1[(i + 14) & 15]); }
+
+//  compress "nblocks" blocks from "data0" into "state0" and from "data1"
+//  into "state1" (any alignment)
+
+void rv32_sha256_blocks_x2(uint32_t state0[8], const uint8_t * data0,
+						   uint32_t state1[8], const uint8_t * data1,
+						   size_t nblocks)
+{
+	int i;
+	uint32_t a0, b0, c0, d0, e0, f0, g0, h0;
+	uint32_t a1, b1, c1, d1, e1, f1, g1, h1;
+	uint32_t m0[16], m1[16];
+	const uint32_t *kp;
+
+	a0 = state0[0];
+	b0 = state0[1];
+	c0 = state0[2];
+	d0 = state0[3];
+	e0 = state0[4];
+	f0 = state0[5];
+	g0 = state0[6];
+	h0 = state0[7];
+
+	a1 = state1[0];
+	b1 = state1[1];
+	c1 = state1[2];
+	d1 = state1[3];
+	e1 = state1[4];
+	f1 = state1[5];
+	g1 = state1[6];
+	h1 = state1[7];
+
+	for (; nblocks > 0; nblocks--) {
+
+		for (i = 0; i < 16; i++) {
+			m0[i] = ld32u_be(data0 + 4 * i);
+			m1[i] = ld32u_be(data1 + 4 * i);
+		}
+		data0 += 64;
+		data1 += 64;
+		kp = sha256_k;
+
+		while (1) {
+
+			SHA256R2(a, b, c, d, e, f, g, h, 0);	//  rounds
+			SHA256R2(h, a, b, c, d, e, f, g, 1);
+			SHA256R2(g, h, a, b, c, d, e, f, 2);
+			SHA256R2(f, g, h, a, b, c, d, e, 3);
+			SHA256R2(e, f, g, h, a, b, c, d, 4);
+			SHA256R2(d, e, f, g, h, a, b, c, 5);
+			SHA256R2(c, d, e, f, g, h, a, b, 6);
+			SHA256R2(b, c, d, e, f, g, h, a, 7);
+			SHA256R2(a, b, c, d, e, f, g, h, 8);
+			SHA256R2(h, a, b, c, d, e, f, g, 9);
+			SHA256R2(g, h, a, b, c, d, e, f, 10);
+			SHA256R2(f, g, h, a, b, c, d, e, 11);
+			SHA256R2(e, f, g, h, a, b, c, d, 12);
+			SHA256R2(d, e, f, g, h, a, b, c, 13);
+			SHA256R2(c, d, e, f, g, h, a, b, 14);
+			SHA256R2(b, c, d, e, f, g, h, a, 15);
+
+			if (kp == &sha256_k[64 - 16])
+				break;
+			kp += 16;
+
+			SHA256K2(0);						//  message schedules
+			SHA256K2(1);
+			SHA256K2(2);
+			SHA256K2(3);
+			SHA256K2(4);
+			SHA256K2(5);
+			SHA256K2(6);
+			SHA256K2(7);
+			SHA256K2(8);
+			SHA256K2(9);
+			SHA256K2(10);
+			SHA256K2(11);
+			SHA256K2(12);
+			SHA256K2(13);
+			SHA256K2(14);
+			SHA256K2(15);
+		}
+
+		a0 = a0 + state0[0];				//  feed-forward, a..h carry on
+		b0 = b0 + state0[1];
+		c0 = c0 + state0[2];
+		d0 = d0 + state0[3];
+		e0 = e0 + state0[4];
+		f0 = f0 + state0[5];
+		g0 = g0 + state0[6];
+		h0 = h0 + state0[7];
+		state0[0] = a0;
+		state0[1] = b0;
+		state0[2] = c0;
+		state0[3] = d0;
+		state0[4] = e0;
+		state0[5] = f0;
+		state0[6] = g0;
+		state0[7] = h0;
+
+		a1 = a1 + state1[0];
+		b1 = b1 + state1[1];
+		c1 = c1 + state1[2];
+		d1 = d1 + state1[3];
+		e1 = e1 + state1[4];
+		f1 = f1 + state1[5];
+		g1 = g1 + state1[6];
+		h1 = h1 + state1[7];
+		state1[0] = a1;
+		state1[1] = b1;
+		state1[2] = c1;
+		state1[3] = d1;
+		state1[4] = e1;
+		state1[5] = f1;
+		state1[6] = g1;
+		state1[7] = h1;
+	}
+}
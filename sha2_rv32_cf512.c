@@ -2,15 +2,51 @@
 //  2020-03-08  Markku-Juhani O. Saarinen <mjos@pqshield.com>
 //  Copyright (c) 2020, PQShield Ltd. All rights reserved.
 
-//  FIPS 180-4 SHA2-384/512 compression function for RV32
+//  FIPS 180-4 SHA2-384/512 compression function for RV32. With
+//  RV32_SHA512_ADC defined this file builds rv32_sha512_blocks_adc() instead,
+//  with 64-bit additions made of a carry-setting ADD and an ADC; see
+//  sha2_rv32_cf512adc.c.
 
 #include <string.h>
 
 #include "sha2_wrap.h"
+#include "rv_endian.h"
 
 //  bitmanip (emulation) prototypes here
 #include "bitmanip.h"
 
+//  ADD, SLTU, and ADC instructions are counted in emulation builds
+
+#ifdef __riscv
+#define OPCNT(x)
+#else
+#define OPCNT(x)	{ x; }
+#endif
+
+#ifdef RV32_SHA512_ADC
+
+//  Hypothetical carry-setting ADD and ADC emulation; "rv32_cf" is the
+//  carry register. This pair replaces ADD, SLTU, ADD, ADD.
+
+static uint32_t rv32_cf = 0;
+
+uint32_t rv32_addc(uint32_t rs1, uint32_t rs2)
+{
+	uint32_t rd = rs1 + rs2;
+
+	rv32_cf = rd < rs2 ? 1 : 0;
+	return rd;
+}
+
+uint32_t rv32_adc(uint32_t rs1, uint32_t rs2)
+{
+	return rs1 + rs2 + rv32_cf;
+}
+
+#else
+
+unsigned long rv32_sha512_add = 0, rv32_sha512_sltu = 0, rv32_sha512_adc = 0;
+
 //  RV32I base SLTU emulation
 
 uint32_t rv32_sltu(uint32_t rs1, uint32_t rs2)
@@ -21,6 +57,45 @@ uint32_t rv32_sltu(uint32_t rs1, uint32_t rs2)
 //  4.1.3 SHA-384, SHA-512, SHA-512/224 and SHA-512/256 Functions
 //  These six instructions are the ISA Extension proposal.
 
+#if defined(__riscv_zknh) && (__riscv_xlen == 32)
+
+//  ratified Zknh (RV32): sha512sum0r and sha512sum1r give both the low
+//  and, with the inputs flipped, the high word
+
+#include <riscv_crypto.h>
+
+uint32_t sha512_sum0l(uint32_t rs1, uint32_t rs2)
+{
+	return __riscv_sha512sum0r(rs1, rs2);
+}
+
+uint32_t sha512_sum1l(uint32_t rs1, uint32_t rs2)
+{
+	return __riscv_sha512sum1r(rs1, rs2);
+}
+
+uint32_t sha512_sig0l(uint32_t rs1, uint32_t rs2)
+{
+	return __riscv_sha512sig0l(rs1, rs2);
+}
+
+uint32_t sha512_sig0h(uint32_t rs1, uint32_t rs2)
+{
+	return __riscv_sha512sig0h(rs1, rs2);
+}
+
+uint32_t sha512_sig1l(uint32_t rs1, uint32_t rs2)
+{
+	return __riscv_sha512sig1l(rs1, rs2);
+}
+
+uint32_t sha512_sig1h(uint32_t rs1, uint32_t rs2)
+{
+	return __riscv_sha512sig1h(rs1, rs2);
+}
+
+#else
+
 //  low word of Sigma0 ("sum0") x=rs2_rs1: (x >>> 28) ^ (x >>> 34) ^ (x >>> 39)
 //  ( high word can be obtained by flipping the input words x=rs1_rs2 )
 
@@ -69,23 +144,45 @@ uint32_t sha512_sig1h(uint32_t rs1, uint32_t rs2)
 	return (rs1 << 3) ^ (rs1 >> 6) ^ (rs1 >> 19) ^ (rs2 >> 29) ^ (rs2 << 13);
 }
 
+#endif
+
 
 //  (((a | c) & b) | (c & a)) = Maj(a, b, c)
 //  (g ^ (e & (f ^ g))) = Ch(e, f, g)
 
+#endif
+
+#ifdef RV32_SHA512_ADC
+
+//  64-bit addition; 1 * ADD (sets carry), 1 * ADC
+
+#define ADD64(dl, dh, s1l, s1h, s2l, s2h) {					\
+	OPCNT(rv32_sha512_add++; rv32_sha512_adc++)				\
+	dl = rv32_addc(s1l, s2l);								\
+	dh = rv32_adc(s1h, s2h);								}
+
+#define RV32_SHA512_BLOCKS	rv32_sha512_blocks_adc
+
+#else
+
 //  64-bit addition; 3 * ADD, 1 * SLTU
 
-#define ADD64(dl, dh, s1l, s1h, s2l, s2h) {	\
-	dl = s1l + s2l;							\
-	dh = s1h + s2h + rv32_sltu(dl, s2l);	}
+#define ADD64(dl, dh, s1l, s1h, s2l, s2h) {					\
+	OPCNT(rv32_sha512_add += 3; rv32_sha512_sltu++)			\
+	dl = s1l + s2l;											\
+	dh = s1h + s2h + rv32_sltu(dl, s2l);					}
 
-//  final Merkle-Damgard addition
+#define RV32_SHA512_BLOCKS	rv32_sha512_blocks
 
-#define LSADD64(p0, p1, xl, xh) 	{	\
-	tl = p0 + xl;						\
-	th = p1 + xh + rv32_sltu(tl, xl);	\
-	p0 = tl;							\
-	p1 = th;							}
+#endif
+
+//  final Merkle-Damgard addition; the sum stays in xl, xh for the next block
+
+#define LSADD64(p, xl, xh) 	{				\
+	tl = (uint32_t) p;						\
+	th = (uint32_t) (p >> 32);				\
+	ADD64(xl, xh, xl, xh, tl, th);			\
+	p = (((uint64_t) xh) << 32) | xl;		}
 
 #define SHA512K(i) {												\
 	tl = mp[i];														\
@@ -124,10 +221,10 @@ uint32_t sha512_sig1h(uint32_t rs1, uint32_t rs2)
 	th = (((x1 | x5) & x3) | (x5 & x1));				\
 	ADD64(xe, xf, xe, xf, tl, th);						}
 
-//  compression function (this one does *not* modify m[16])
+//  compress "nblocks" 128-byte blocks from "data" (any alignment)
 
-
-void rv32_sha512_compress(void *s)
+void RV32_SHA512_BLOCKS(uint64_t state[8],
+						const uint8_t * data, size_t nblocks)
 {
 	//  4.2.3 SHA-384, SHA-512, SHA-512/224 and SHA-512/256 Constants
 
@@ -166,97 +263,109 @@ void rv32_sha512_compress(void *s)
 		0x597F299C, 0x3AD6FAEC, 0x5FCB6FAB, 0x4A475817, 0x6C44198C
 	};
 
-	uint32_t *sp = s;
-	uint32_t *mp = sp + 16;
-	const uint32_t *kp = ck;
+	uint32_t m[32], *mp;
+	const uint32_t *kp;
 
 	uint32_t tl, th, ul, uh;
 	uint32_t al, ah, bl, bh, cl, ch, dl, dh, el, eh, fl, fh, gl, gh, hl, hh;
 
-	al = sp[0];
-	ah = sp[1];
-	bl = sp[2];
-	bh = sp[3];
-	cl = sp[4];
-	ch = sp[5];
-	dl = sp[6];
-	dh = sp[7];
-	el = sp[8];
-	eh = sp[9];
-	fl = sp[10];
-	fh = sp[11];
-	gl = sp[12];
-	gh = sp[13];
-	hl = sp[14];
-	hh = sp[15];
-
-	mp = sp + 16;
-	do {
-		tl = mp[1];							//  revert tje block
-		th = mp[0];
-		mp[0] = rv32b_grev(tl, 0x18);
-		mp[1] = rv32b_grev(th, 0x18);
-		mp += 2;
-	} while (mp != sp + 48);
-
-	mp = sp + 16;
-
-	while (1) {
-
+	al = (uint32_t) state[0];
+	ah = (uint32_t) (state[0] >> 32);
+	bl = (uint32_t) state[1];
+	bh = (uint32_t) (state[1] >> 32);
+	cl = (uint32_t) state[2];
+	ch = (uint32_t) (state[2] >> 32);
+	dl = (uint32_t) state[3];
+	dh = (uint32_t) (state[3] >> 32);
+	el = (uint32_t) state[4];
+	eh = (uint32_t) (state[4] >> 32);
+	fl = (uint32_t) state[5];
+	fh = (uint32_t) (state[5] >> 32);
+	gl = (uint32_t) state[6];
+	gh = (uint32_t) (state[6] >> 32);
+	hl = (uint32_t) state[7];
+	hh = (uint32_t) (state[7] >> 32);
+
+	for (; nblocks > 0; nblocks--) {
+
+		mp = m;								//  local copy of the block
 		do {
-
-			SHA512R(al, ah, bl, bh, cl, ch, dl, dh,
-					el, eh, fl, fh, gl, gh, hl, hh, 0);
-			SHA512R(hl, hh, al, ah, bl, bh, cl, ch,
-					dl, dh, el, eh, fl, fh, gl, gh, 2);
-			SHA512R(gl, gh, hl, hh, al, ah, bl, bh,
-					cl, ch, dl, dh, el, eh, fl, fh, 4);
-			SHA512R(fl, fh, gl, gh, hl, hh, al, ah,
-					bl, bh, cl, ch, dl, dh, el, eh, 6);
-			SHA512R(el, eh, fl, fh, gl, gh, hl, hh,
-					al, ah, bl, bh, cl, ch, dl, dh, 8);
-			SHA512R(dl, dh, el, eh, fl, fh, gl, gh,
-					hl, hh, al, ah, bl, bh, cl, ch, 10);
-			SHA512R(cl, ch, dl, dh, el, eh, fl, fh,
-					gl, gh, hl, hh, al, ah, bl, bh, 12);
-			SHA512R(bl, bh, cl, ch, dl, dh, el, eh,
-					fl, fh, gl, gh, hl, hh, al, ah, 14);
-
-			kp += 16;
-			mp += 16;
-
-		} while (mp != sp + 48);
-
-		if (kp == &ck[160])
-			break;
-
-		mp = sp + 16;
-
-		SHA512K(0);
-		SHA512K(2);
-		SHA512K(4);
-		SHA512K(6);
-		SHA512K(8);
-		SHA512K(10);
-		SHA512K(12);
-		SHA512K(14);
-		SHA512K(16);
-		SHA512K(18);
-		SHA512K(20);
-		SHA512K(22);
-		SHA512K(24);
-		SHA512K(26);
-		SHA512K(28);
-		SHA512K(30);
+			mp[0] = ld32u_be(data + 4);
+			mp[1] = ld32u_be(data);
+			data += 8;
+			mp += 2;
+		} while (mp != m + 32);
+
+		mp = m;
+		kp = ck;
+
+		while (1) {
+
+			do {
+
+				SHA512R(al, ah, bl, bh, cl, ch, dl, dh,
+						el, eh, fl, fh, gl, gh, hl, hh, 0);
+				SHA512R(hl, hh, al, ah, bl, bh, cl, ch,
+						dl, dh, el, eh, fl, fh, gl, gh, 2);
+				SHA512R(gl, gh, hl, hh, al, ah, bl, bh,
+						cl, ch, dl, dh, el, eh, fl, fh, 4);
+				SHA512R(fl, fh, gl, gh, hl, hh, al, ah,
+						bl, bh, cl, ch, dl, dh, el, eh, 6);
+				SHA512R(el, eh, fl, fh, gl, gh, hl, hh,
+						al, ah, bl, bh, cl, ch, dl, dh, 8);
+				SHA512R(dl, dh, el, eh, fl, fh, gl, gh,
+						hl, hh, al, ah, bl, bh, cl, ch, 10);
+				SHA512R(cl, ch, dl, dh, el, eh, fl, fh,
+						gl, gh, hl, hh, al, ah, bl, bh, 12);
+				SHA512R(bl, bh, cl, ch, dl, dh, el, eh,
+						fl, fh, gl, gh, hl, hh, al, ah, 14);
+
+				kp += 16;
+				mp += 16;
+
+			} while (mp != m + 32);
+
+			if (kp == &ck[160])
+				break;
+
+			mp = m;
+
+			SHA512K(0);
+			SHA512K(2);
+			SHA512K(4);
+			SHA512K(6);
+			SHA512K(8);
+			SHA512K(10);
+			SHA512K(12);
+			SHA512K(14);
+			SHA512K(16);
+			SHA512K(18);
+			SHA512K(20);
+			SHA512K(22);
+			SHA512K(24);
+			SHA512K(26);
+			SHA512K(28);
+			SHA512K(30);
+		}
+
+		LSADD64(state[0], al, ah);
+		LSADD64(state[1], bl, bh);
+		LSADD64(state[2], cl, ch);
+		LSADD64(state[3], dl, dh);
+		LSADD64(state[4], el, eh);
+		LSADD64(state[5], fl, fh);
+		LSADD64(state[6], gl, gh);
+		LSADD64(state[7], hl, hh);
 	}
+}
+
+#ifndef RV32_SHA512_ADC
 
-	LSADD64(sp[0], sp[1], al, ah);
-	LSADD64(sp[2], sp[3], bl, bh);
-	LSADD64(sp[4], sp[5], cl, ch);
-	LSADD64(sp[6], sp[7], dl, dh);
-	LSADD64(sp[8], sp[9], el, eh);
-	LSADD64(sp[10], sp[11], fl, fh);
-	LSADD64(sp[12], sp[13], gl, gh);
-	LSADD64(sp[14], sp[15], hl, hh);
+//  compression function of the old layout: state s[0..7], block s[8..23]
 
+void rv32_sha512_compress(void *s)
+{
+	rv32_sha512_blocks((uint64_t *) s, (const uint8_t *) s + 64, 1);
 }
+
+#endif
@@ -0,0 +1,128 @@
+//  sha2_rv32_cf512adc.c
+//  2020-03-12  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  SHA2-384/512 compression function for RV32 with a hypothetical
+//  carry-setting ADD and ADC pair: the same kernel as sha2_rv32_cf512.c,
+//  built with RV32_SHA512_ADC. Also a dataflow model of the critical path
+//  of both variants.
+
+#define RV32_SHA512_ADC
+#include "sha2_rv32_cf512.c"
+
+//  === Critical path model ===
+
+//  Each value carries the earliest cycle at which it is available. All
+//  instructions have unit latency and there is no issue limit; loads and
+//  round constants are free. The macros follow ADD64, SHA512K, and SHA512R,
+//  in program order.
+//
+//  "adc" is 0 for ADD, SLTU; 1 for ADD, ADC with the carry register
+//  renamed, so that independent pairs overlap freely; 2 for ADD, ADC with
+//  one carry register and no renaming. Then a carry-setting ADD waits for
+//  the ADC of the previous pair to read the flag (WAR; the read and the
+//  new write may be in the same cycle), which also orders the writes
+//  (WAW). "cf" is the cycle of that last read.
+
+#define TMAX(a, b)	((a) > (b) ? (a) : (b))
+
+static void tadd64(int *dl, int *dh, int s1l, int s1h, int s2l, int s2h,
+				   int adc, int *cf)
+{
+	int l, h;
+
+	l = TMAX(s1l, s2l);
+	if (adc == 2)
+		l = TMAX(l, *cf - 1);
+	l++;									//  ADD (sets carry)
+	if (adc) {
+		h = TMAX(TMAX(s1h, s2h), l) + 1;	//  ADC
+		*cf = h;
+	} else {
+		h = TMAX(s1h, s2h) + 1;				//  ADD
+		h = TMAX(h, l + 1) + 1;				//  SLTU, ADD
+	}
+	*dl = l;
+	*dh = h;
+}
+
+//  one round with the state rotated by "r" words, message word pair "i"
+
+static void tround(int s[16], int r, const int m[32], int i, int adc,
+				   int *cf)
+{
+	int *x[16], tl, th, k;
+
+	for (k = 0; k < 8; k++) {
+		x[2 * k] = &s[2 * ((k - r) & 7)];
+		x[2 * k + 1] = &s[2 * ((k - r) & 7) + 1];
+	}
+
+	tadd64(x[14], x[15], *x[14], *x[15], m[i], m[i + 1], adc, cf);
+	tadd64(x[14], x[15], *x[14], *x[15], 0, 0, adc, cf);
+	tl = TMAX(TMAX(TMAX(*x[10], *x[12]) + 1, *x[8]) + 1, *x[12]) + 1;
+	th = TMAX(TMAX(TMAX(*x[11], *x[13]) + 1, *x[9]) + 1, *x[13]) + 1;
+	tadd64(x[14], x[15], *x[14], *x[15], tl, th, adc, cf);
+	tl = TMAX(*x[8], *x[9]) + 1;
+	th = tl;
+	tadd64(x[14], x[15], *x[14], *x[15], tl, th, adc, cf);
+	tadd64(x[6], x[7], *x[6], *x[7], *x[14], *x[15], adc, cf);
+	tl = TMAX(*x[0], *x[1]) + 1;
+	th = tl;
+	tadd64(x[14], x[15], *x[14], *x[15], tl, th, adc, cf);
+	tl = TMAX(TMAX(TMAX(*x[0], *x[4]) + 1, *x[2]) + 1,
+			  TMAX(*x[4], *x[0]) + 1) + 1;
+	th = TMAX(TMAX(TMAX(*x[1], *x[5]) + 1, *x[3]) + 1,
+			  TMAX(*x[5], *x[1]) + 1) + 1;
+	tadd64(x[14], x[15], *x[14], *x[15], tl, th, adc, cf);
+}
+
+//  one message schedule step for word pair "i"
+
+static void tmsg(int m[32], int i, int adc, int *cf)
+{
+	int tl, th, ul, uh;
+
+	tadd64(&tl, &th, m[i], m[i + 1], m[(i + 18) & 0x1F],
+		   m[(i + 19) & 0x1F], adc, cf);
+	ul = TMAX(m[(i + 2) & 0x1F], m[(i + 3) & 0x1F]) + 1;
+	uh = ul;
+	tadd64(&tl, &th, tl, th, ul, uh, adc, cf);
+	ul = TMAX(m[(i + 28) & 0x1F], m[(i + 29) & 0x1F]) + 1;
+	uh = ul;
+	tadd64(&tl, &th, tl, th, ul, uh, adc, cf);
+	m[i] = tl;
+	m[i + 1] = th;
+}
+
+//  Critical path of one block from the chaining value and message to the
+//  new chaining value, in instructions; "adc" selects the variant and the
+//  carry model as above.
+
+int rv32_sha512_cpath(int adc)
+{
+	int s[16], m[32], i, j, d, cf;
+
+	for (i = 0; i < 16; i++)
+		s[i] = 0;
+	for (i = 0; i < 32; i++)
+		m[i] = 0;
+	cf = 0;
+
+	for (j = 0; j < 80; j += 16) {
+		if (j > 0) {
+			for (i = 0; i < 32; i += 2)
+				tmsg(m, i, adc, &cf);
+		}
+		for (i = 0; i < 16; i++)
+			tround(s, i & 7, m, 2 * i, adc, &cf);
+	}
+
+	d = 0;
+	for (i = 0; i < 16; i += 2) {			//  LSADD64 feed-forward
+		tadd64(&s[i], &s[i + 1], s[i], s[i + 1], 0, 0, adc, &cf);
+		d = TMAX(d, TMAX(s[i], s[i + 1]));
+	}
+
+	return d;
+}
@@ -0,0 +1,191 @@
+//  sha2_rv64_cf256x2.c
+//  2020-03-16  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  FIPS 180-4 SHA2-224/256 compression of two independent messages on RV64
+//  without a vector unit ("SWAR"). Each 64-bit register holds word i of
+//  both states, message 0 in the low half and message 1 in the high half.
+//  AND, OR, and XOR work on both halves as they are; the additions and the
+//  sigma functions need paired 32-bit forms, which are emulated here as
+//  hypothetical instructions. Instructions are counted in emulation builds.
+
+#include "sha2_wrap.h"
+#include "rv_endian.h"
+
+#ifdef __riscv
+#define OPCNT(x)
+#else
+#define OPCNT(x)	{ x; }
+#endif
+
+unsigned long rv64_sha256x2_add = 0, rv64_sha256x2_sha = 0,
+	rv64_sha256x2_logic = 0, rv64_sha256x2_ld = 0, rv64_sha256x2_pack = 0;
+
+//  Paired 32-bit addition ADD32 (as in the P extension proposal)
+
+uint64_t rv64_add32(uint64_t rs1, uint64_t rs2)
+{
+	return ((uint32_t) (rs1 + rs2)) | (((rs1 >> 32) + (rs2 >> 32)) << 32);
+}
+
+//  Paired SHA-256 sigma functions; sha256sum0 etc. on both halves
+
+uint64_t sha256_sum0p(uint64_t rs1)
+{
+	return ((uint64_t) sha256_sum0(rs1 >> 32) << 32) |
+		sha256_sum0((uint32_t) rs1);
+}
+
+uint64_t sha256_sum1p(uint64_t rs1)
+{
+	return ((uint64_t) sha256_sum1(rs1 >> 32) << 32) |
+		sha256_sum1((uint32_t) rs1);
+}
+
+uint64_t sha256_sig0p(uint64_t rs1)
+{
+	return ((uint64_t) sha256_sig0(rs1 >> 32) << 32) |
+		sha256_sig0((uint32_t) rs1);
+}
+
+uint64_t sha256_sig1p(uint64_t rs1)
+{
+	return ((uint64_t) sha256_sig1(rs1 >> 32) << 32) |
+		sha256_sig1((uint32_t) rs1);
+}
+
+//  PACK (Zbkb): low halves of rs1 and rs2 to the low and high halves of rd
+
+static uint64_t rv64_pack(uint64_t rs1, uint64_t rs2)
+{
+	OPCNT(rv64_sha256x2_pack++)
+	return ((uint32_t) rs1) | (rs2 << 32);
+}
+
+//  round constants in both halves, loaded with LD
+
+#define K2(x) (((uint64_t) (x) << 32) | (x))
+
+static const uint64_t sha256_k2[64] = { SHA256_K_LIST(K2) };
+
+//  processing step, 7 * ADD32, 2 * SHA, 7 * logic, 1 * LD (constant)
+
+#define SHA256R(a, b, c, d, e, f, g, h, mi, ki) {						\
+	OPCNT(rv64_sha256x2_add += 7; rv64_sha256x2_sha += 2;				\
+		rv64_sha256x2_logic += 7; rv64_sha256x2_ld++)					\
+	h = rv64_add32(h, g ^ (e & (f ^ g)));								\
+	h = rv64_add32(h, mi);												\
+	h = rv64_add32(h, ki);												\
+	h = rv64_add32(h, sha256_sum1p(e));									\
+	d = rv64_add32(d, h);												\
+	h = rv64_add32(h, sha256_sum0p(a));									\
+	h = rv64_add32(h, ((a | c) & b) | (c & a));							}
+
+//  keying step, 3 * ADD32, 2 * SHA
+
+#define SHA256K(x0, x1, x9, xe) {										\
+	OPCNT(rv64_sha256x2_add += 3; rv64_sha256x2_sha += 2)				\
+	x0 = rv64_add32(x0, x9);											\
+	x0 = rv64_add32(x0, sha256_sig0p(x1));								\
+	x0 = rv64_add32(x0, sha256_sig1p(xe));								}
+
+//  compress "nblocks" blocks from "data0" into "state0" and from "data1"
+//  into "state1" (any alignment); same interface as sha256_blocks_x2
+
+void rv64_sha256_blocks_x2(uint32_t state0[8], const uint8_t * data0,
+						   uint32_t state1[8], const uint8_t * data1,
+						   size_t nblocks)
+{
+	int i;
+	uint64_t a, b, c, d, e, f, g, h, s[8], m[16];
+	const uint64_t *kp;
+
+	for (i = 0; i < 8; i++)
+		s[i] = rv64_pack(state0[i], state1[i]);
+
+	a = s[0];
+	b = s[1];
+	c = s[2];
+	d = s[3];
+	e = s[4];
+	f = s[5];
+	g = s[6];
+	h = s[7];
+
+	for (; nblocks > 0; nblocks--) {
+
+		for (i = 0; i < 16; i++) {			//  2 * LW (rev8.w), 1 * PACK
+			OPCNT(rv64_sha256x2_ld += 2)
+			m[i] = rv64_pack(ld32u_be(data0 + 4 * i),
+							 ld32u_be(data1 + 4 * i));
+		}
+		data0 += 64;
+		data1 += 64;
+		kp = sha256_k2;
+
+		while (1) {
+
+			SHA256R(a, b, c, d, e, f, g, h, m[0], kp[0]);	//  rounds
+			SHA256R(h, a, b, c, d, e, f, g, m[1], kp[1]);
+			SHA256R(g, h, a, b, c, d, e, f, m[2], kp[2]);
+			SHA256R(f, g, h, a, b, c, d, e, m[3], kp[3]);
+			SHA256R(e, f, g, h, a, b, c, d, m[4], kp[4]);
+			SHA256R(d, e, f, g, h, a, b, c, m[5], kp[5]);
+			SHA256R(c, d, e, f, g, h, a, b, m[6], kp[6]);
+			SHA256R(b, c, d, e, f, g, h, a, m[7], kp[7]);
+			SHA256R(a, b, c, d, e, f, g, h, m[8], kp[8]);
+			SHA256R(h, a, b, c, d, e, f, g, m[9], kp[9]);
+			SHA256R(g, h, a, b, c, d, e, f, m[10], kp[10]);
+			SHA256R(f, g, h, a, b, c, d, e, m[11], kp[11]);
+			SHA256R(e, f, g, h, a, b, c, d, m[12], kp[12]);
+			SHA256R(d, e, f, g, h, a, b, c, m[13], kp[13]);
+			SHA256R(c, d, e, f, g, h, a, b, m[14], kp[14]);
+			SHA256R(b, c, d, e, f, g, h, a, m[15], kp[15]);
+
+			if (kp == &sha256_k2[64 - 16])
+				break;
+			kp += 16;
+
+			SHA256K(m[0], m[1], m[9], m[14]);	//  message schedule
+			SHA256K(m[1], m[2], m[10], m[15]);
+			SHA256K(m[2], m[3], m[11], m[0]);
+			SHA256K(m[3], m[4], m[12], m[1]);
+			SHA256K(m[4], m[5], m[13], m[2]);
+			SHA256K(m[5], m[6], m[14], m[3]);
+			SHA256K(m[6], m[7], m[15], m[4]);
+			SHA256K(m[7], m[8], m[0], m[5]);
+			SHA256K(m[8], m[9], m[1], m[6]);
+			SHA256K(m[9], m[10], m[2], m[7]);
+			SHA256K(m[10], m[11], m[3], m[8]);
+			SHA256K(m[11], m[12], m[4], m[9]);
+			SHA256K(m[12], m[13], m[5], m[10]);
+			SHA256K(m[13], m[14], m[6], m[11]);
+			SHA256K(m[14], m[15], m[7], m[12]);
+			SHA256K(m[15], m[0], m[8], m[13]);
+		}
+
+		OPCNT(rv64_sha256x2_add += 8)		//  feed-forward, a..h carry on
+		a = rv64_add32(a, s[0]);
+		b = rv64_add32(b, s[1]);
+		c = rv64_add32(c, s[2]);
+		d = rv64_add32(d, s[3]);
+		e = rv64_add32(e, s[4]);
+		f = rv64_add32(f, s[5]);
+		g = rv64_add32(g, s[6]);
+		h = rv64_add32(h, s[7]);
+		s[0] = a;
+		s[1] = b;
+		s[2] = c;
+		s[3] = d;
+		s[4] = e;
+		s[5] = f;
+		s[6] = g;
+		s[7] = h;
+	}
+
+	for (i = 0; i < 8; i++) {				//  ZEXT.W and SRLI
+		OPCNT(rv64_sha256x2_pack += 2)
+		state0[i] = (uint32_t) s[i];
+		state1[i] = s[i] >> 32;
+	}
+}
@@ -0,0 +1,210 @@
+//  sha2_scan256.c
+//  2020-03-08  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  SHA2-256 of "prefix | nonce | suffix" for many 32-bit nonces. The prefix
+//  blocks are compressed once; in the last block the rounds before the
+//  nonce word and the message schedule terms that do not depend on it are
+//  computed once in sha2_256_scan_init().
+
+#include <string.h>
+#include "sha2_wrap.h"
+#include "rv_endian.h"
+
+//  flags for nonce-dependent terms of W[t]
+
+#define DEP_SIG1	1						//  sig1(W[t - 2])
+#define DEP_W7		2						//  W[t - 7]
+#define DEP_SIG0	4						//  sig0(W[t - 15])
+#define DEP_W16		8						//  W[t - 16]
+#define DEP_NONCE	16						//  the nonce word itself
+
+//  set up a scan; returns -1 if the nonce is not word-aligned in the
+//  last block or if nonce, suffix, and padding do not fit in it
+
+int sha2_256_scan_init(sha2_256_scan_t * sc,
+					   const void *prefix, size_t prefixlen,
+					   const void *suffix, size_t suffixlen)
+{
+	int i, t;
+	uint32_t a, b, c, d, e, f, g, h, x;
+	sha2_256_ctx_t ctx;
+	uint8_t *mp;
+
+	sha2_256_init(&ctx);					//  all full prefix blocks
+	sha2_256_update(&ctx, prefix, prefixlen);
+
+	i = ctx.len & 63;
+	if ((i & 3) != 0 || i + 4 + suffixlen > 55)
+		return -1;
+
+	mp = ctx.b;								//  last block, nonce = 0
+	memset(mp + i, 0x00, 4);
+	memcpy(mp + i + 4, suffix, suffixlen);
+	i += 4 + suffixlen;
+	mp[i++] = 0x80;
+	memset(mp + i, 0x00, 56 - i);
+	put64u_be(mp + 56, (prefixlen + 4 + suffixlen) << 3);
+
+	sc->ni = (ctx.len & 63) >> 2;
+	for (i = 0; i < 8; i++)
+		sc->h[i] = ctx.s[i];
+
+	for (t = 0; t < 16; t++) {
+		sc->w[t] = get32u_be(mp + 4 * t);
+		sc->wf[t] = t == sc->ni ? DEP_NONCE : 0;
+	}
+
+	//  constant part of W[t]; the full word if nothing depends on the nonce
+
+	for (t = 16; t < 64; t++) {
+		x = 0;
+		sc->wf[t] = 0;
+		if (sc->wf[t - 2])
+			sc->wf[t] |= DEP_SIG1;
+		else
+			x += sha256_sig1(sc->w[t - 2]);
+		if (sc->wf[t - 7])
+			sc->wf[t] |= DEP_W7;
+		else
+			x += sc->w[t - 7];
+		if (sc->wf[t - 15])
+			sc->wf[t] |= DEP_SIG0;
+		else
+			x += sha256_sig0(sc->w[t - 15]);
+		if (sc->wf[t - 16])
+			sc->wf[t] |= DEP_W16;
+		else
+			x += sc->w[t - 16];
+		sc->w[t] = x;
+	}
+
+	//  rounds before the nonce
+
+	a = sc->h[0];
+	b = sc->h[1];
+	c = sc->h[2];
+	d = sc->h[3];
+	e = sc->h[4];
+	f = sc->h[5];
+	g = sc->h[6];
+	h = sc->h[7];
+
+	for (t = 0; t < sc->ni; t++) {
+		x = h + sha256_sum1(e) + (g ^ (e & (f ^ g))) + sha256_k[t] + sc->w[t];
+		h = g;
+		g = f;
+		f = e;
+		e = d + x;
+		d = c;
+		c = b;
+		b = a;
+		a = x + sha256_sum0(b) + (((b | d) & c) | (d & b));
+	}
+
+	sc->s[0] = a;
+	sc->s[1] = b;
+	sc->s[2] = c;
+	sc->s[3] = d;
+	sc->s[4] = e;
+	sc->s[5] = f;
+	sc->s[6] = g;
+	sc->s[7] = h;
+
+	return 0;
+}
+
+//  the remaining rounds for nonce "n"; hash value words to v[8]
+
+static void scan256(const sha2_256_scan_t * sc, uint32_t n, uint32_t v[8])
+{
+	int t;
+	uint32_t a, b, c, d, e, f, g, h, x, w[64];
+
+	w[sc->ni] = n;							//  only these words change
+	for (t = sc->ni + 1; t < 64; t++) {
+		x = sc->w[t];
+		if (sc->wf[t] & DEP_SIG1)
+			x += sha256_sig1(w[t - 2]);
+		if (sc->wf[t] & DEP_W7)
+			x += w[t - 7];
+		if (sc->wf[t] & DEP_SIG0)
+			x += sha256_sig0(w[t - 15]);
+		if (sc->wf[t] & DEP_W16)
+			x += w[t - 16];
+		w[t] = x;
+	}
+
+	a = sc->s[0];
+	b = sc->s[1];
+	c = sc->s[2];
+	d = sc->s[3];
+	e = sc->s[4];
+	f = sc->s[5];
+	g = sc->s[6];
+	h = sc->s[7];
+
+	for (t = sc->ni; t < 64; t++) {
+		x = h + sha256_sum1(e) + (g ^ (e & (f ^ g))) + sha256_k[t] + w[t];
+		h = g;
+		g = f;
+		f = e;
+		e = d + x;
+		d = c;
+		c = b;
+		b = a;
+		a = x + sha256_sum0(b) + (((b | d) & c) | (d & b));
+	}
+
+	v[0] = sc->h[0] + a;
+	v[1] = sc->h[1] + b;
+	v[2] = sc->h[2] + c;
+	v[3] = sc->h[3] + d;
+	v[4] = sc->h[4] + e;
+	v[5] = sc->h[5] + f;
+	v[6] = sc->h[6] + g;
+	v[7] = sc->h[7] + h;
+}
+
+//  32-byte hash of "prefix | nonce | suffix" with a single nonce
+
+void sha2_256_scan_hash(uint8_t * md, const sha2_256_scan_t * sc,
+						uint32_t nonce)
+{
+	int i;
+	uint32_t v[8];
+
+	scan256(sc, nonce, v);
+	for (i = 0; i < 8; i++)
+		put32u_be(&md[i << 2], v[i]);
+}
+
+//  find the first nonce in [first, first + count) whose hash, as a big
+//  endian number, is at most "target"; returns 1 if found, 0 otherwise
+
+int sha2_256_scan(uint32_t * nonce, uint8_t * md,
+				  const sha2_256_scan_t * sc, const uint8_t * target,
+				  uint32_t first, uint32_t count)
+{
+	int i;
+	uint32_t n, v[8], tw[8];
+
+	for (i = 0; i < 8; i++)
+		tw[i] = get32u_be(target + 4 * i);
+
+	for (n = first; count > 0; n++, count--) {
+
+		scan256(sc, n, v);
+
+		for (i = 0; i < 8 && v[i] == tw[i]; i++)	//  usually exits at v[0]
+			;
+		if (i == 8 || v[i] < tw[i]) {
+			*nonce = n;
+			for (i = 0; i < 8; i++)
+				put32u_be(&md[i << 2], v[i]);
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -11,203 +11,467 @@
 
 //  pointers to the compression functions
 
-void (*sha256_compress)(void *s) = &rv32_sha256_compress;
-void (*sha512_compress)(void *s) = &rv64_sha512_compress;
-
-//  shared part between SHA-224 and SHA-256
-
-static void sha256pad(uint32_t * s,
-					  const uint8_t * k, size_t klen, uint8_t pad,
-					  const void *in, size_t inlen)
+void (*sha256_blocks)(uint32_t *, const uint8_t *, size_t) =
+	&rv32_sha256_blocks;
+#if defined(__riscv) && (__riscv_xlen == 32) && \
+	defined(__riscv_zknh) && defined(__riscv_zbkb)
+void (*sha512_blocks)(uint64_t *, const uint8_t *, size_t) =
+	&rv32_sha512_blocks_asm;
+#elif defined(__riscv) && (__riscv_xlen == 32)
+void (*sha512_blocks)(uint64_t *, const uint8_t *, size_t) =
+	&rv32_sha512_blocks;
+#else
+void (*sha512_blocks)(uint64_t *, const uint8_t *, size_t) =
+	&rv64_sha512_blocks;
+#endif
+void (*sha256_blocks_x2)(uint32_t *, const uint8_t *,
+						 uint32_t *, const uint8_t *, size_t) =
+	&rv32_sha256_blocks_x2;
+
+//  SHA-224 and SHA-256 absorb any number of bytes
+
+void sha2_256_update(sha2_256_ctx_t * c, const void *in, size_t inlen)
 {
 	size_t i;
-	uint64_t x;
-	uint8_t *mp = (uint8_t *) & s[8];
 	const uint8_t *ip = in;
 
-	x = inlen << 3;							//  length in bits
-
-	if (k != NULL) {						//  key block for HMAC
-		x += 512;
-		for (i = 0; i < klen; i++)
-			mp[i] = k[i] ^ pad;
-		memset(mp + klen, pad, 64 - klen);
-		sha256_compress(s);
+	i = c->len & 63;						//  partial block in buffer
+	c->len += inlen;
+
+	if (i > 0) {
+		if (i + inlen < 64) {				//  still no full block
+			memcpy(c->b + i, ip, inlen);
+			return;
+		}
+		memcpy(c->b + i, ip, 64 - i);
+		sha256_blocks(c->s, c->b, 1);
+		inlen -= 64 - i;
+		ip += 64 - i;
 	}
 
-	while (inlen >= 64) {					//  full blocks
-		memcpy(mp, ip, 64);
-		sha256_compress(s);
-		inlen -= 64;
-		ip += 64;
-	}
-	memcpy(mp, ip, inlen);					//  last data block
-	mp[inlen++] = 0x80;
-	if (inlen > 56) {
-		memset(mp + inlen, 0x00, 64 - inlen);
-		sha256_compress(s);
-		inlen = 0;
+	if (inlen >= 64) {						//  full blocks, in place
+		sha256_blocks(c->s, ip, inlen / 64);
+		ip += inlen & ~((size_t) 63);
+		inlen &= 63;
 	}
+	memcpy(c->b, ip, inlen);				//  keep the rest
+}
+
+//  shared padding and finalization between SHA-224 and SHA-256
 
-	i = 64;									//  process length
-	while (x > 0) {
-		mp[--i] = x & 0xFF;
-		x >>= 8;
+static void sha256fin(sha2_256_ctx_t * c)
+{
+	size_t i;
+	uint8_t *mp = c->b;
+
+	i = c->len & 63;						//  last data block
+	mp[i++] = 0x80;
+	if (i > 56) {
+		memset(mp + i, 0x00, 64 - i);
+		sha256_blocks(c->s, mp, 1);
+		i = 0;
 	}
-	memset(mp + inlen, 0x00, i - inlen);
-	sha256_compress(s);
+	memset(mp + i, 0x00, 56 - i);
+	put64u_be(mp + 56, c->len << 3);		//  length in bits
+	sha256_blocks(c->s, mp, 1);
 }
 
-//  SHA-224 initial values H0, Sect 5.3.2.
+//  finalize and store big endian output
 
-static const uint32_t sha2_224_h0[8] = {
-	0xC1059ED8, 0x367CD507, 0x3070DD17, 0xF70E5939,
-	0xFFC00B31, 0x68581511, 0x64F98FA7, 0xBEFA4FA4
-};
+void sha2_256_final(uint8_t * md, sha2_256_ctx_t * c)
+{
+	int i;
 
-//  Compute 28-byte message digest to "md" from "in" which has "inlen" bytes
+	sha256fin(c);
+	for (i = 0; i < c->mdlen; i += 4)
+		put32u_be(&md[i], c->s[i >> 2]);
+}
 
-void sha2_224(uint8_t * md, const void *in, size_t inlen)
+//  set the initial value
+
+static void sha256ini(sha2_256_ctx_t * c, const uint32_t h0[8], int mdlen)
 {
 	int i;
-	uint32_t s[8 + 24];
 
 	for (i = 0; i < 8; i++)					//  set H0 (IV)
-		s[i] = sha2_224_h0[i];
+		c->s[i] = h0[i];
+	c->len = 0;
+	c->mdlen = mdlen;
+}
 
-	sha256pad(s, NULL, 0, 0x00, in, inlen);
+//  HMAC key setup: chaining states after the K ^ ipad and K ^ opad blocks
 
-	for (i = 0; i < 7; i++)					//  store big endian output
-		put32u_be(&md[i << 2], s[i]);
+static void hmac256key(hmac_sha2_256_key_t * key,
+					   const uint32_t h0[8], int mdlen,
+					   const void *k, size_t klen)
+{
+	size_t i;
+	sha2_256_ctx_t c;
+	uint8_t k0[32], b[64];
+	const uint8_t *kp = k;
 
+	if (klen > 64) {						//  hash the key if needed
+		sha256ini(&c, h0, mdlen);
+		sha2_256_update(&c, k, klen);
+		sha2_256_final(k0, &c);
+		kp = k0;
+		klen = mdlen;
+	}
+
+	for (i = 0; i < klen; i++)				//  inner key block
+		b[i] = kp[i] ^ 0x36;
+	memset(b + klen, 0x36, 64 - klen);
+	for (i = 0; i < 8; i++)
+		key->hi[i] = h0[i];
+	sha256_blocks(key->hi, b, 1);
+
+	for (i = 0; i < 64; i++)				//  outer key block
+		b[i] ^= 0x36 ^ 0x5C;
+	for (i = 0; i < 8; i++)
+		key->ho[i] = h0[i];
+	sha256_blocks(key->ho, b, 1);
+
+	key->mdlen = mdlen;
 }
 
-void hmac_sha2_224(uint8_t * mac, const void *k, size_t klen,
-				   const void *in, size_t inlen)
+//  HMAC-SHA2-224/256 from a key object: inner hash starts from the midstate
+
+void hmac_sha2_256_init(hmac_sha2_256_ctx_t * h,
+						const hmac_sha2_256_key_t * key)
 {
 	int i;
-	uint32_t s[8 + 16];
-	uint8_t t[28], k0[28];
 
-	if (klen > 64) {						//  hash the key if needed
-		sha2_224(k0, k, klen);
-		k = k0;
-		klen = 28;
+	for (i = 0; i < 8; i++) {
+		h->c.s[i] = key->hi[i];
+		h->ho[i] = key->ho[i];
 	}
+	h->c.len = 64;
+	h->c.mdlen = key->mdlen;
+}
 
-	for (i = 0; i < 8; i++)					//  set H0 (IV)
-		s[i] = sha2_224_h0[i];
+void hmac_sha2_256_update(hmac_sha2_256_ctx_t * h,
+						  const void *in, size_t inlen)
+{
+	sha2_256_update(&h->c, in, inlen);
+}
 
-	sha256pad(s, k, klen, 0x36, in, inlen);
+//  outer hash is a single compression from the outer midstate
 
-	for (i = 0; i < 7; i++)					//  get temporary, reinit
-		put32u_be(&t[i << 2], s[i]);
+void hmac_sha2_256_final(uint8_t * mac, hmac_sha2_256_ctx_t * h)
+{
+	int i;
+	uint8_t t[32];
+
+	sha2_256_final(t, &h->c);
 	for (i = 0; i < 8; i++)
-		s[i] = sha2_224_h0[i];				//  set H0 (IV)
+		h->c.s[i] = h->ho[i];
+	h->c.len = 64;
+	sha2_256_update(&h->c, t, h->c.mdlen);
+	sha2_256_final(mac, &h->c);
+}
 
-	sha256pad(s, k, klen, 0x5c, t, 28);
+void hmac_sha2_256_mac(uint8_t * mac, const hmac_sha2_256_key_t * key,
+					   const void *in, size_t inlen)
+{
+	hmac_sha2_256_ctx_t h;
 
-	for (i = 0; i < 7; i++)					//  store big endian output
-		put32u_be(&mac[i << 2], s[i]);
+	hmac_sha2_256_init(&h, key);
+	hmac_sha2_256_update(&h, in, inlen);
+	hmac_sha2_256_final(mac, &h);
+}
+
+//  constant-time check of a (possibly truncated) "mac"; zero if it matches
+
+int hmac_sha2_256_verify(const hmac_sha2_256_key_t * key,
+						 const uint8_t * mac, size_t maclen,
+						 const void *in, size_t inlen)
+{
+	size_t i;
+	uint8_t t[32], x;
+
+	if (maclen == 0 || maclen > (size_t) key->mdlen)
+		return -1;
+
+	hmac_sha2_256_mac(t, key, in, inlen);
+	x = 0;
+	for (i = 0; i < maclen; i++)
+		x |= t[i] ^ mac[i];
+
+	return x != 0;
+}
+
+//  SHA-224 initial values H0, Sect 5.3.2.
+
+static const uint32_t sha2_224_h0[8] = {
+	0xC1059ED8, 0x367CD507, 0x3070DD17, 0xF70E5939,
+	0xFFC00B31, 0x68581511, 0x64F98FA7, 0xBEFA4FA4
+};
+
+void sha2_224_init(sha2_256_ctx_t * c)
+{
+	sha256ini(c, sha2_224_h0, 28);
+}
+
+//  Compute 28-byte message digest to "md" from "in" which has "inlen" bytes
+
+void sha2_224(uint8_t * md, const void *in, size_t inlen)
+{
+	sha2_256_ctx_t c;
+
+	sha2_224_init(&c);
+	sha2_256_update(&c, in, inlen);
+	sha2_256_final(md, &c);
+}
+
+void hmac_sha2_224_key(hmac_sha2_256_key_t * key, const void *k, size_t klen)
+{
+	hmac256key(key, sha2_224_h0, 28, k, klen);
+}
+
+void hmac_sha2_224(uint8_t * mac, const void *k, size_t klen,
+				   const void *in, size_t inlen)
+{
+	hmac_sha2_256_key_t key;
+
+	hmac_sha2_224_key(&key, k, klen);
+	hmac_sha2_256_mac(mac, &key, in, inlen);
 }
 
 //  SHA-256 initial values H0, Sect 5.3.3.
 
-static const uint32_t sha2_256_h0[8] = {
+const uint32_t sha2_256_h0[8] = {
 	0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
 	0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
 };
 
+void sha2_256_init(sha2_256_ctx_t * c)
+{
+	sha256ini(c, sha2_256_h0, 32);
+}
+
 //  Compute 32-byte message digest to "md" from "in" which has "inlen" bytes
 
 void sha2_256(uint8_t * md, const void *in, size_t inlen)
 {
-	int i;
-	uint32_t s[8 + 16];
+	sha2_256_ctx_t c;
 
-	for (i = 0; i < 8; i++)					//  set H0 (IV)
-		s[i] = sha2_256_h0[i];
+	sha2_256_init(&c);
+	sha2_256_update(&c, in, inlen);
+	sha2_256_final(md, &c);
+}
+
+//  Two 32-byte digests; common full blocks are compressed side by side
+
+void sha2_256_x2(uint8_t * md0, const void *in0, size_t inlen0,
+				 uint8_t * md1, const void *in1, size_t inlen1)
+{
+	size_t n;
+	sha2_256_ctx_t c0, c1;
+
+	sha2_256_init(&c0);
+	sha2_256_init(&c1);
+
+	n = (inlen0 < inlen1 ? inlen0 : inlen1) / 64;
+	if (n > 0) {
+		sha256_blocks_x2(c0.s, in0, c1.s, in1, n);
+		c0.len = 64 * n;
+		c1.len = 64 * n;
+	}
 
-	sha256pad(s, NULL, 0, 0x00, in, inlen);
+	sha2_256_update(&c0, (const uint8_t *) in0 + 64 * n, inlen0 - 64 * n);
+	sha2_256_final(md0, &c0);
+	sha2_256_update(&c1, (const uint8_t *) in1 + 64 * n, inlen1 - 64 * n);
+	sha2_256_final(md1, &c1);
+}
 
-	for (i = 0; i < 8; i++)					//  store big endian output
-		put32u_be(&md[i << 2], s[i]);
+void hmac_sha2_256_key(hmac_sha2_256_key_t * key, const void *k, size_t klen)
+{
+	hmac256key(key, sha2_256_h0, 32, k, klen);
 }
 
 void hmac_sha2_256(uint8_t * mac, const void *k, size_t klen,
 				   const void *in, size_t inlen)
 {
-	int i;
-	uint32_t s[8 + 16];
-	uint8_t t[32], k0[32];
+	hmac_sha2_256_key_t key;
 
-	if (klen > 64) {						//  hash the key if needed
-		sha2_256(k0, k, klen);
-		k = k0;
-		klen = 32;
+	hmac_sha2_256_key(&key, k, klen);
+	hmac_sha2_256_mac(mac, &key, in, inlen);
+}
+
+
+//  SHA-384 and SHA-512 absorb any number of bytes
+
+void sha2_512_update(sha2_512_ctx_t * c, const void *in, size_t inlen)
+{
+	size_t i;
+	const uint8_t *ip = in;
+
+	i = c->len & 127;						//  partial block in buffer
+	c->len += inlen;
+
+	if (i > 0) {
+		if (i + inlen < 128) {				//  still no full block
+			memcpy(c->b + i, ip, inlen);
+			return;
+		}
+		memcpy(c->b + i, ip, 128 - i);
+		sha512_blocks(c->s, c->b, 1);
+		inlen -= 128 - i;
+		ip += 128 - i;
 	}
 
-	for (i = 0; i < 8; i++)					//  set H0 (IV)
-		s[i] = sha2_256_h0[i];
+	if (inlen >= 128) {						//  full blocks, in place
+		sha512_blocks(c->s, ip, inlen / 128);
+		ip += inlen & ~((size_t) 127);
+		inlen &= 127;
+	}
+	memcpy(c->b, ip, inlen);				//  keep the rest
+}
 
-	sha256pad(s, k, klen, 0x36, in, inlen);
+//  shared padding and finalization between SHA-384 and SHA-512
 
-	for (i = 0; i < 8; i++) {				//  get temporary, reinit
-		put32u_be(&t[i << 2], s[i]);
-		s[i] = sha2_256_h0[i];				//  set H0 (IV)
+static void sha512fin(sha2_512_ctx_t * c)
+{
+	size_t i;
+	uint8_t *mp = c->b;
+
+	i = c->len & 127;						//  last data block
+	mp[i++] = 0x80;
+	if (i > 112) {
+		memset(mp + i, 0x00, 128 - i);
+		sha512_blocks(c->s, mp, 1);
+		i = 0;
 	}
+	memset(mp + i, 0x00, 112 - i);
+	put64u_be(mp + 112, c->len >> 61);		//  128-bit length in bits
+	put64u_be(mp + 120, c->len << 3);
+	sha512_blocks(c->s, mp, 1);
+}
 
-	sha256pad(s, k, klen, 0x5c, t, 32);
+//  finalize and store big endian output (may end in a partial word)
 
-	for (i = 0; i < 8; i++)					//  store big endian output
-		put32u_be(&mac[i << 2], s[i]);
+void sha2_512_final(uint8_t * md, sha2_512_ctx_t * c)
+{
+	int i;
+	uint8_t t[64];
+
+	sha512fin(c);
+	for (i = 0; i < 8; i++)
+		put64u_be(&t[i << 3], c->s[i]);
+	memcpy(md, t, c->mdlen);
 }
 
+//  set the initial value
 
-//  shared part between SHA-384 and SHA-512
+static void sha512ini(sha2_512_ctx_t * c, const uint64_t h0[8], int mdlen)
+{
+	int i;
 
-static void sha512pad(uint64_t s[8],
-					  const uint8_t * k, size_t klen, uint8_t pad,
-					  const void *in, size_t inlen)
+	for (i = 0; i < 8; i++)					//  set H0 (IV)
+		c->s[i] = h0[i];
+	c->len = 0;
+	c->mdlen = mdlen;
+}
+
+//  HMAC key setup: chaining states after the K ^ ipad and K ^ opad blocks
+
+static void hmac512key(hmac_sha2_512_key_t * key,
+					   const uint64_t h0[8], int mdlen,
+					   const void *k, size_t klen)
 {
 	size_t i;
-	uint64_t x;
+	sha2_512_ctx_t c;
+	uint8_t k0[64], b[128];
+	const uint8_t *kp = k;
 
-	uint8_t *mp = (uint8_t *) & s[8];
-	const uint8_t *ip = in;
+	if (klen > 128) {						//  hash the key if needed
+		sha512ini(&c, h0, mdlen);
+		sha2_512_update(&c, k, klen);
+		sha2_512_final(k0, &c);
+		kp = k0;
+		klen = mdlen;
+	}
 
-	x = inlen << 3;							//  length in bits
+	for (i = 0; i < klen; i++)				//  inner key block
+		b[i] = kp[i] ^ 0x36;
+	memset(b + klen, 0x36, 128 - klen);
+	for (i = 0; i < 8; i++)
+		key->hi[i] = h0[i];
+	sha512_blocks(key->hi, b, 1);
 
-	if (k != NULL) {						//  key block for HMAC
-		x += 1024;
-		for (i = 0; i < klen; i++)
-			mp[i] = k[i] ^ pad;
-		memset(mp + klen, pad, 128 - klen);
-		sha512_compress(s);
-	}
+	for (i = 0; i < 128; i++)				//  outer key block
+		b[i] ^= 0x36 ^ 0x5C;
+	for (i = 0; i < 8; i++)
+		key->ho[i] = h0[i];
+	sha512_blocks(key->ho, b, 1);
 
-	while (inlen >= 128) {					//  full blocks
-		memcpy(mp, ip, 128);
-		sha512_compress(s);
-		inlen -= 128;
-		ip += 128;
-	}
+	key->mdlen = mdlen;
+}
 
-	memcpy(mp, ip, inlen);					//  last data block
-	mp[inlen++] = 0x80;
-	if (inlen > 112) {
-		memset(mp + inlen, 0x00, 128 - inlen);
-		sha512_compress(s);
-		inlen = 0;
-	}
+//  HMAC-SHA2-384/512 from a key object: inner hash starts from the midstate
 
-	i = 128;								//  process length
-	while (x > 0) {
-		mp[--i] = x & 0xFF;
-		x >>= 8;
+void hmac_sha2_512_init(hmac_sha2_512_ctx_t * h,
+						const hmac_sha2_512_key_t * key)
+{
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		h->c.s[i] = key->hi[i];
+		h->ho[i] = key->ho[i];
 	}
-	memset(mp + inlen, 0x00, i - inlen);
-	sha512_compress(s);
+	h->c.len = 128;
+	h->c.mdlen = key->mdlen;
+}
+
+void hmac_sha2_512_update(hmac_sha2_512_ctx_t * h,
+						  const void *in, size_t inlen)
+{
+	sha2_512_update(&h->c, in, inlen);
+}
+
+//  outer hash is a single compression from the outer midstate
+
+void hmac_sha2_512_final(uint8_t * mac, hmac_sha2_512_ctx_t * h)
+{
+	int i;
+	uint8_t t[64];
+
+	sha2_512_final(t, &h->c);
+	for (i = 0; i < 8; i++)
+		h->c.s[i] = h->ho[i];
+	h->c.len = 128;
+	sha2_512_update(&h->c, t, h->c.mdlen);
+	sha2_512_final(mac, &h->c);
+}
+
+void hmac_sha2_512_mac(uint8_t * mac, const hmac_sha2_512_key_t * key,
+					   const void *in, size_t inlen)
+{
+	hmac_sha2_512_ctx_t h;
+
+	hmac_sha2_512_init(&h, key);
+	hmac_sha2_512_update(&h, in, inlen);
+	hmac_sha2_512_final(mac, &h);
+}
+
+//  constant-time check of a (possibly truncated) "mac"; zero if it matches
+
+int hmac_sha2_512_verify(const hmac_sha2_512_key_t * key,
+						 const uint8_t * mac, size_t maclen,
+						 const void *in, size_t inlen)
+{
+	size_t i;
+	uint8_t t[64], x;
+
+	if (maclen == 0 || maclen > (size_t) key->mdlen)
+		return -1;
+
+	hmac_sha2_512_mac(t, key, in, inlen);
+	x = 0;
+	for (i = 0; i < maclen; i++)
+		x |= t[i] ^ mac[i];
+
+	return x != 0;
 }
 
 //  SHA-384 initial values H0, Sect 5.3.4.
@@ -219,102 +483,207 @@ static const uint64_t sha2_384_h0[8] = {
 	0xDB0C2E0D64F98FA7LL, 0x47B5481DBEFA4FA4LL
 };
 
+void sha2_384_init(sha2_512_ctx_t * c)
+{
+	sha512ini(c, sha2_384_h0, 48);
+}
+
 //  Compute 48-byte message digest to "md" from "in" which has "inlen" bytes
 
 void sha2_384(uint8_t * md, const void *in, size_t inlen)
 {
-	int i;
-	uint64_t s[8 + 16];
+	sha2_512_ctx_t c;
 
-	for (i = 0; i < 8; i++)					//  set H0 (IV)
-		s[i] = sha2_384_h0[i];
-
-	sha512pad(s, NULL, 0, 0x00, in, inlen);
+	sha2_384_init(&c);
+	sha2_512_update(&c, in, inlen);
+	sha2_512_final(md, &c);
+}
 
-	for (i = 0; i < 6; i++)					//  store big endian output
-		put64u_be(&md[i << 3], s[i]);
+void hmac_sha2_384_key(hmac_sha2_512_key_t * key, const void *k, size_t klen)
+{
+	hmac512key(key, sha2_384_h0, 48, k, klen);
 }
 
 void hmac_sha2_384(uint8_t * mac, const void *k, size_t klen,
 				   const void *in, size_t inlen)
 {
-	int i;
-	uint64_t s[8 + 16];
-	uint8_t t[48], k0[48];
+	hmac_sha2_512_key_t key;
 
-	if (klen > 128) {						//  hash the key if needed
-		sha2_384(k0, k, klen);
-		k = k0;
-		klen = 48;
-	}
-
-	for (i = 0; i < 8; i++)					//  set H0 (IV)
-		s[i] = sha2_384_h0[i];
-
-	sha512pad(s, k, klen, 0x36, in, inlen);
-
-	for (i = 0; i < 6; i++) {				//  get temporary, reinit
-		put64u_be(&t[i << 3], s[i]);
-	}
-	for (i = 0; i < 8; i++)					//  set H0 (IV)
-		s[i] = sha2_384_h0[i];
-
-	sha512pad(s, k, klen, 0x5c, t, 48);
-
-	for (i = 0; i < 6; i++)					//  store big endian output
-		put64u_be(&mac[i << 3], s[i]);
+	hmac_sha2_384_key(&key, k, klen);
+	hmac_sha2_512_mac(mac, &key, in, inlen);
 }
 
 //  SHA-512 initial values H0, Sect 5.3.5.
 
-static const uint64_t sha2_512_h0[8] = {
+const uint64_t sha2_512_h0[8] = {
 	0x6A09E667F3BCC908LL, 0xBB67AE8584CAA73BLL,
 	0x3C6EF372FE94F82BLL, 0xA54FF53A5F1D36F1LL,
 	0x510E527FADE682D1LL, 0x9B05688C2B3E6C1FLL,
 	0x1F83D9ABFB41BD6BLL, 0x5BE0CD19137E2179LL
 };
 
+void sha2_512_init(sha2_512_ctx_t * c)
+{
+	sha512ini(c, sha2_512_h0, 64);
+}
+
 //  Compute 64-byte message digest to "md" from "in" which has "inlen" bytes
 
 void sha2_512(uint8_t * md, const void *in, size_t inlen)
 {
-	int i;
-	uint64_t s[8 + 16];
-
-	for (i = 0; i < 8; i++)					//  set H0 (IV)
-		s[i] = sha2_512_h0[i];
+	sha2_512_ctx_t c;
 
-	sha512pad(s, NULL, 0, 0x00, in, inlen);
+	sha2_512_init(&c);
+	sha2_512_update(&c, in, inlen);
+	sha2_512_final(md, &c);
+}
 
-	for (i = 0; i < 8; i++)					//  store big endian output
-		put64u_be(&md[i << 3], s[i]);
+void hmac_sha2_512_key(hmac_sha2_512_key_t * key, const void *k, size_t klen)
+{
+	hmac512key(key, sha2_512_h0, 64, k, klen);
 }
 
 void hmac_sha2_512(uint8_t * mac, const void *k, size_t klen,
 				   const void *in, size_t inlen)
+{
+	hmac_sha2_512_key_t key;
+
+	hmac_sha2_512_key(&key, k, klen);
+	hmac_sha2_512_mac(mac, &key, in, inlen);
+}
+
+//  SHA-512/224 initial values H0, Sect 5.3.6.1.
+
+static const uint64_t sha2_512_224_h0[8] = {
+	0x8C3D37C819544DA2LL, 0x73E1996689DCD4D6LL,
+	0x1DFAB7AE32FF9C82LL, 0x679DD514582F9FCFLL,
+	0x0F6D2B697BD44DA8LL, 0x77E36F7304C48942LL,
+	0x3F9D85A86A1D36C8LL, 0x1112E6AD91D692A1LL
+};
+
+void sha2_512_224_init(sha2_512_ctx_t * c)
+{
+	sha512ini(c, sha2_512_224_h0, 28);
+}
+
+//  Compute 28-byte message digest to "md" from "in" which has "inlen" bytes
+
+void sha2_512_224(uint8_t * md, const void *in, size_t inlen)
+{
+	sha2_512_ctx_t c;
+
+	sha2_512_224_init(&c);
+	sha2_512_update(&c, in, inlen);
+	sha2_512_final(md, &c);
+}
+
+void hmac_sha2_512_224_key(hmac_sha2_512_key_t * key,
+						   const void *k, size_t klen)
+{
+	hmac512key(key, sha2_512_224_h0, 28, k, klen);
+}
+
+void hmac_sha2_512_224(uint8_t * mac, const void *k, size_t klen,
+					   const void *in, size_t inlen)
+{
+	hmac_sha2_512_key_t key;
+
+	hmac_sha2_512_224_key(&key, k, klen);
+	hmac_sha2_512_mac(mac, &key, in, inlen);
+}
+
+//  SHA-512/256 initial values H0, Sect 5.3.6.2.
+
+static const uint64_t sha2_512_256_h0[8] = {
+	0x22312194FC2BF72CLL, 0x9F555FA3C84C64C2LL,
+	0x2393B86B6F53B151LL, 0x963877195940EABDLL,
+	0x96283EE2A88EFFE3LL, 0xBE5E1E2553863992LL,
+	0x2B0199FC2C85B8AALL, 0x0EB72DDC81C52CA2LL
+};
+
+void sha2_512_256_init(sha2_512_ctx_t * c)
+{
+	sha512ini(c, sha2_512_256_h0, 32);
+}
+
+//  Compute 32-byte message digest to "md" from "in" which has "inlen" bytes
+
+void sha2_512_256(uint8_t * md, const void *in, size_t inlen)
+{
+	sha2_512_ctx_t c;
+
+	sha2_512_256_init(&c);
+	sha2_512_update(&c, in, inlen);
+	sha2_512_final(md, &c);
+}
+
+void hmac_sha2_512_256_key(hmac_sha2_512_key_t * key,
+						   const void *k, size_t klen)
+{
+	hmac512key(key, sha2_512_256_h0, 32, k, klen);
+}
+
+void hmac_sha2_512_256(uint8_t * mac, const void *k, size_t klen,
+					   const void *in, size_t inlen)
+{
+	hmac_sha2_512_key_t key;
+
+	hmac_sha2_512_256_key(&key, k, klen);
+	hmac_sha2_512_mac(mac, &key, in, inlen);
+}
+
+//  SHA-512/t IV generation, Sect 5.3.6: SHA-512 of "SHA-512/t" with the
+//  SHA-512 IV xored with A5A5.. as the initial value. Returns -1 for
+//  lengths not allowed here.
+
+static int sha512t_h0(uint64_t h0[8], int t)
 {
 	int i;
-	uint64_t s[8 + 16];
-	uint8_t t[64], k0[64];
+	char str[16];
+	sha2_512_ctx_t c;
 
-	if (klen > 128) {						//  hash the key if needed
-		sha2_512(k0, k, klen);
-		k = k0;
-		klen = 64;
-	}
+	if (t <= 0 || t >= 512 || t == 384 || (t & 7) != 0)
+		return -1;
 
-	for (i = 0; i < 8; i++)					//  set H0 (IV)
-		s[i] = sha2_512_h0[i];
+	for (i = 0; i < 8; i++)
+		h0[i] = sha2_512_h0[i] ^ 0xA5A5A5A5A5A5A5A5LL;
+	sha512ini(&c, h0, 64);
+
+	i = 0;									//  "SHA-512/t" with decimal t
+	memcpy(str, "SHA-512/", 8);
+	if (t >= 100)
+		str[8 + i++] = '0' + t / 100;
+	if (t >= 10)
+		str[8 + i++] = '0' + (t / 10) % 10;
+	str[8 + i++] = '0' + t % 10;
+
+	sha2_512_update(&c, str, 8 + i);
+	sha512fin(&c);
+	for (i = 0; i < 8; i++)
+		h0[i] = c.s[i];
+
+	return 0;
+}
+
+int sha2_512t_init(sha2_512_ctx_t * c, int t)
+{
+	uint64_t h0[8];
 
-	sha512pad(s, k, klen, 0x36, in, inlen);
+	if (sha512t_h0(h0, t) != 0)
+		return -1;
+	sha512ini(c, h0, t >> 3);
 
-	for (i = 0; i < 8; i++) {				//  get temporary, reinit
-		put64u_be(&t[i << 3], s[i]);
-		s[i] = sha2_512_h0[i];				//  set H0 (IV)
-	}
+	return 0;
+}
+
+int hmac_sha2_512t_key(hmac_sha2_512_key_t * key, int t,
+					   const void *k, size_t klen)
+{
+	uint64_t h0[8];
 
-	sha512pad(s, k, klen, 0x5c, t, 64);
+	if (sha512t_h0(h0, t) != 0)
+		return -1;
+	hmac512key(key, h0, t >> 3, k, klen);
 
-	for (i = 0; i < 8; i++)					//  store big endian output
-		put64u_be(&mac[i << 3], s[i]);
+	return 0;
 }
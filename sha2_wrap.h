@@ -24,6 +24,9 @@ void sha2_384(uint8_t * md, const void *in, size_t inlen);
 //  SHA2-512: Compute 64-byte hash to "md" from "in" which has "inlen" bytes.
 void sha2_512(uint8_t * md, const void *in, size_t inlen);
 
+//  SHA2-512/224 and SHA2-512/256: 28 or 32-byte hash to "md", SHA2-512 speed.
+void sha2_512_224(uint8_t * md, const void *in, size_t inlen);
+void sha2_512_256(uint8_t * md, const void *in, size_t inlen);
 
 //  === HMAC wrappers ===
 
@@ -43,19 +46,433 @@ void hmac_sha2_384(uint8_t * mac, const void *k, size_t klen,
 void hmac_sha2_512(uint8_t * mac, const void *k, size_t klen,
 				   const void *in, size_t inlen);
 
+//  HMAC-SHA2-512/224 and /256: Compute 28 or 32-byte "mac" with key "k".
+void hmac_sha2_512_224(uint8_t * mac, const void *k, size_t klen,
+					   const void *in, size_t inlen);
+void hmac_sha2_512_256(uint8_t * mac, const void *k, size_t klen,
+					   const void *in, size_t inlen);
+
+//  === Incremental interface ===
+
+typedef struct {							//  SHA2-224/256 context
+	uint32_t s[8];							//  chaining state
+	uint8_t b[64];							//  partial block
+	uint64_t len;							//  bytes processed
+	int mdlen;								//  hash output in bytes
+} sha2_256_ctx_t;
+
+typedef struct {							//  SHA2-384/512 context
+	uint64_t s[8];							//  chaining state
+	uint8_t b[128];							//  partial block
+	uint64_t len;							//  bytes processed
+	int mdlen;								//  hash output in bytes
+} sha2_512_ctx_t;
+
+//  SHA2-224 and SHA2-256 share update and final; "md" gets mdlen bytes
+void sha2_224_init(sha2_256_ctx_t * c);
+void sha2_256_init(sha2_256_ctx_t * c);
+void sha2_256_update(sha2_256_ctx_t * c, const void *in, size_t inlen);
+void sha2_256_final(uint8_t * md, sha2_256_ctx_t * c);
+
+//  SHA2-384 and SHA2-512 share update and final; "md" gets mdlen bytes
+void sha2_384_init(sha2_512_ctx_t * c);
+void sha2_512_init(sha2_512_ctx_t * c);
+
+//  SHA2-512/t also share them; t is a multiple of 8 below 512, not 384.
+//  sha2_512t_init() generates the IV (Sect. 5.3.6) and returns 0, or -1.
+void sha2_512_224_init(sha2_512_ctx_t * c);
+void sha2_512_256_init(sha2_512_ctx_t * c);
+int sha2_512t_init(sha2_512_ctx_t * c, int t);
+
+//  SHA2-256 and SHA2-512 initial values H0 (sha2_wrap.c)
+extern const uint32_t sha2_256_h0[8];
+extern const uint64_t sha2_512_h0[8];
+
+void sha2_512_update(sha2_512_ctx_t * c, const void *in, size_t inlen);
+void sha2_512_final(uint8_t * md, sha2_512_ctx_t * c);
+
+//  === HMAC key objects ===
+
+typedef struct {							//  HMAC-SHA2-224/256 key
+	uint32_t hi[8], ho[8];					//  after K ^ ipad, K ^ opad
+	int mdlen;								//  MAC length in bytes
+} hmac_sha2_256_key_t;
+
+typedef struct {							//  HMAC-SHA2-384/512 key
+	uint64_t hi[8], ho[8];					//  after K ^ ipad, K ^ opad
+	int mdlen;								//  MAC length in bytes
+} hmac_sha2_512_key_t;
+
+typedef struct {							//  HMAC-SHA2-224/256 context
+	sha2_256_ctx_t c;						//  inner hash
+	uint32_t ho[8];							//  outer midstate
+} hmac_sha2_256_ctx_t;
+
+typedef struct {							//  HMAC-SHA2-384/512 context
+	sha2_512_ctx_t c;						//  inner hash
+	uint64_t ho[8];							//  outer midstate
+} hmac_sha2_512_ctx_t;
+
+//  Precompute the two midstates from key "k" of "klen" bytes.
+void hmac_sha2_224_key(hmac_sha2_256_key_t * key, const void *k, size_t klen);
+void hmac_sha2_256_key(hmac_sha2_256_key_t * key, const void *k, size_t klen);
+void hmac_sha2_384_key(hmac_sha2_512_key_t * key, const void *k, size_t klen);
+void hmac_sha2_512_key(hmac_sha2_512_key_t * key, const void *k, size_t klen);
+void hmac_sha2_512_224_key(hmac_sha2_512_key_t * key,
+						   const void *k, size_t klen);
+void hmac_sha2_512_256_key(hmac_sha2_512_key_t * key,
+						   const void *k, size_t klen);
+int hmac_sha2_512t_key(hmac_sha2_512_key_t * key, int t,
+					   const void *k, size_t klen);
+
+//  One-shot MAC of mdlen bytes with a key object.
+void hmac_sha2_256_mac(uint8_t * mac, const hmac_sha2_256_key_t * key,
+					   const void *in, size_t inlen);
+void hmac_sha2_512_mac(uint8_t * mac, const hmac_sha2_512_key_t * key,
+					   const void *in, size_t inlen);
+
+//  Incremental MAC with a key object.
+void hmac_sha2_256_init(hmac_sha2_256_ctx_t * h,
+						const hmac_sha2_256_key_t * key);
+void hmac_sha2_256_update(hmac_sha2_256_ctx_t * h,
+						  const void *in, size_t inlen);
+void hmac_sha2_256_final(uint8_t * mac, hmac_sha2_256_ctx_t * h);
+
+void hmac_sha2_512_init(hmac_sha2_512_ctx_t * h,
+						const hmac_sha2_512_key_t * key);
+void hmac_sha2_512_update(hmac_sha2_512_ctx_t * h,
+						  const void *in, size_t inlen);
+void hmac_sha2_512_final(uint8_t * mac, hmac_sha2_512_ctx_t * h);
+
+//  Constant-time verify of the first "maclen" bytes; returns 0 on match.
+int hmac_sha2_256_verify(const hmac_sha2_256_key_t * key,
+						 const uint8_t * mac, size_t maclen,
+						 const void *in, size_t inlen);
+int hmac_sha2_512_verify(const hmac_sha2_512_key_t * key,
+						 const uint8_t * mac, size_t maclen,
+						 const void *in, size_t inlen);
+
+//  === Fixed prefix and nonce scanning (sha2_scan256.c) ===
+
+typedef struct {							//  SHA2-256 nonce scan
+	uint32_t h[8];							//  state after the prefix blocks
+	uint32_t s[8];							//  .. and the rounds before nonce
+	uint32_t w[64];							//  W[t] or its constant part
+	uint8_t wf[64];							//  nonce-dependent terms of W[t]
+	int ni;									//  nonce word in the last block
+} sha2_256_scan_t;
+
+//  Message is "prefix | nonce | suffix" with a big endian 32-bit nonce that
+//  must be word-aligned in the last block. Returns 0 on success, -1 if not.
+int sha2_256_scan_init(sha2_256_scan_t * sc,
+					   const void *prefix, size_t prefixlen,
+					   const void *suffix, size_t suffixlen);
+
+//  Compute the 32-byte hash "md" with a single "nonce".
+void sha2_256_scan_hash(uint8_t * md, const sha2_256_scan_t * sc,
+						uint32_t nonce);
+
+//  First nonce in [first, first + count) with hash <= "target" (32 bytes,
+//  big endian) to "nonce", hash to "md"; returns 1 if found, 0 otherwise.
+//  "sc" is not modified, so ranges can be given to different threads.
+int sha2_256_scan(uint32_t * nonce, uint8_t * md,
+				  const sha2_256_scan_t * sc, const uint8_t * target,
+				  uint32_t first, uint32_t count);
+
+//  === 64-byte inputs, Merkle nodes (sha2_node256.c) ===
+
+//  SHA2-256 and SHA2-256(SHA2-256()) of exactly 64 bytes to 32-byte "md".
+void sha256_64B(uint8_t * md, const uint8_t * in);
+void sha256d_64B(uint8_t * md, const uint8_t * in);
+
+//  Same for "n" consecutive inputs; "md" may overlap the start of "in".
+void sha256_64B_x(uint8_t * md, const uint8_t * in, size_t n);
+void sha256d_64B_x(uint8_t * md, const uint8_t * in, size_t n);
+
+//  === Two messages in one instruction stream ===
+
+//  SHA2-256 of "in0" to "md0" and of "in1" to "md1". The full blocks they
+//  have in common go through sha256_blocks_x2, the rest one at a time.
+void sha2_256_x2(uint8_t * md0, const void *in0, size_t inlen0,
+				 uint8_t * md1, const void *in1, size_t inlen1);
+
+//  === Multi-buffer (sha2_mb.c, sha2_x86_mb.c) ===
+
+#define SHA2_MB_MAX 16						//  most lanes in a kernel
+
+//  Hash "n" independent messages in[i] of len[i] bytes to md[i] (32 or 64
+//  bytes), one message per lane of the sha256_mb / sha512_mb kernel.
+void sha2_256_batch(uint8_t * md[], const uint8_t * const in[],
+					const size_t len[], size_t n);
+void sha2_512_batch(uint8_t * md[], const uint8_t * const in[],
+					const size_t len[], size_t n);
+
+//  HMAC of "n" messages in[i] under one key object to mac[i] (mdlen bytes)
+void hmac_sha2_256_batch(uint8_t * mac[], const hmac_sha2_256_key_t * key,
+						 const uint8_t * const in[], const size_t len[],
+						 size_t n);
+void hmac_sha2_512_batch(uint8_t * mac[], const hmac_sha2_512_key_t * key,
+						 const uint8_t * const in[], const size_t len[],
+						 size_t n);
+
+//  Lane kernels: one block blk[j] for each lane j with bit j of "mask" set.
+//  State word i of lane j is s[lanes * i + j]. Set the pointer and the
+//  lane count together.
+extern int sha256_mb_lanes;
+extern void (*sha256_mb)(uint32_t *, const uint8_t * const *, uint32_t);
+extern int sha512_mb_lanes;
+extern void (*sha512_mb)(uint64_t *, const uint8_t * const *, uint32_t);
+
+//  portable, one lane after another with sha256_blocks / sha512_blocks
+void c_sha256_x8(uint32_t * s, const uint8_t * const blk[], uint32_t mask);
+void c_sha512_x4(uint64_t * s, const uint8_t * const blk[], uint32_t mask);
+
+#ifdef __AVX2__
+void avx2_sha256_x8(uint32_t * s, const uint8_t * const blk[], uint32_t mask);
+void avx2_sha512_x4(uint64_t * s, const uint8_t * const blk[], uint32_t mask);
+#endif
+#ifdef __AVX512F__
+void avx512_sha256_x16(uint32_t * s, const uint8_t * const blk[],
+					   uint32_t mask);
+void avx512_sha512_x8(uint64_t * s, const uint8_t * const blk[],
+					  uint32_t mask);
+#endif
+
+//  === PBKDF2 (sha2_pbkdf2.c) ===
+
+//  PBKDF2-HMAC-SHA2-256/512: derive "dklen" bytes to "dk" from password
+//  "pw" and "salt" with "c" iterations. Each iteration is two compressions.
+//  Returns 0, or -1 if "dklen" is more than 2^32 - 1 hash lengths.
+int pbkdf2_sha2_256(uint8_t * dk, size_t dklen,
+					const void *pw, size_t pwlen,
+					const void *salt, size_t saltlen, uint32_t c);
+int pbkdf2_sha2_512(uint8_t * dk, size_t dklen,
+					const void *pw, size_t pwlen,
+					const void *salt, size_t saltlen, uint32_t c);
+
+//  The same for "n" passwords pw[i] with salts salt[i] to dk[i] (dklen
+//  bytes each), with every output block in its own sha256_mb / sha512_mb
+//  lane. Several passwords, or one long output, fill the lanes. Returns 0
+//  or -1 like the above.
+int pbkdf2_sha2_256_batch(uint8_t * dk[], size_t dklen,
+						  const uint8_t * const pw[], const size_t pwlen[],
+						  const uint8_t * const salt[],
+						  const size_t saltlen[], uint32_t c, size_t n);
+int pbkdf2_sha2_512_batch(uint8_t * dk[], size_t dklen,
+						  const uint8_t * const pw[], const size_t pwlen[],
+						  const uint8_t * const salt[],
+						  const size_t saltlen[], uint32_t c, size_t n);
+
+//  === HKDF (sha2_hkdf.c) ===
+
+//  HKDF-Extract: PRK (32, 48, or 64 bytes) from "salt" and "ikm". Set the
+//  PRK up once as a key object with hmac_sha2_xxx_key() for Expand.
+void hkdf_sha2_256_extract(uint8_t * prk, const void *salt, size_t saltlen,
+						   const void *ikm, size_t ikmlen);
+void hkdf_sha2_384_extract(uint8_t * prk, const void *salt, size_t saltlen,
+						   const void *ikm, size_t ikmlen);
+void hkdf_sha2_512_extract(uint8_t * prk, const void *salt, size_t saltlen,
+						   const void *ikm, size_t ikmlen);
+
+//  HKDF-Expand: "okmlen" bytes to "okm" from a PRK key object and "info".
+//  The 512 version is also for SHA2-384. Returns 0, or -1 if "okmlen" is
+//  more than 255 hash lengths.
+int hkdf_sha2_256_expand(uint8_t * okm, size_t okmlen,
+						 const hmac_sha2_256_key_t * prk,
+						 const void *info, size_t infolen);
+int hkdf_sha2_512_expand(uint8_t * okm, size_t okmlen,
+						 const hmac_sha2_512_key_t * prk,
+						 const void *info, size_t infolen);
+
+//  Expand "n" labels info[i] to okm[i] of okmlen[i] bytes under one PRK;
+//  each block T(j) of all labels is one hmac_sha2_xxx_batch() call.
+//  Returns 0, or -1 if a length is too large or out of memory.
+int hkdf_sha2_256_expand_batch(uint8_t * okm[], const size_t okmlen[],
+							   const hmac_sha2_256_key_t * prk,
+							   const uint8_t * const info[],
+							   const size_t infolen[], size_t n);
+int hkdf_sha2_512_expand_batch(uint8_t * okm[], const size_t okmlen[],
+							   const hmac_sha2_512_key_t * prk,
+							   const uint8_t * const info[],
+							   const size_t infolen[], size_t n);
+
+//  Extract and Expand. Returns 0 or -1 like Expand.
+int hkdf_sha2_256(uint8_t * okm, size_t okmlen,
+				  const void *salt, size_t saltlen,
+				  const void *ikm, size_t ikmlen,
+				  const void *info, size_t infolen);
+int hkdf_sha2_384(uint8_t * okm, size_t okmlen,
+				  const void *salt, size_t saltlen,
+				  const void *ikm, size_t ikmlen,
+				  const void *info, size_t infolen);
+int hkdf_sha2_512(uint8_t * okm, size_t okmlen,
+				  const void *salt, size_t saltlen,
+				  const void *ikm, size_t ikmlen,
+				  const void *info, size_t infolen);
+
+//  === DRBGs (sha2_drbg.c) ===
+
+#define DRBG_RESEED_INTERVAL	(1ULL << 48)	//  generate calls per seed
+#define DRBG_MAX_REQUEST		(1 << 16)		//  bytes per generate call
+
+typedef struct {							//  SP 800-90A Hash_DRBG
+	int hlen;								//  32 (SHA2-256) or 64 (SHA2-512)
+	int seedlen;							//  55 or 111 bytes
+	uint8_t v[111], c[111];					//  V and C
+	uint64_t rc, rci;						//  reseed counter and interval
+} hash_drbg_t;
+
+typedef struct {							//  SP 800-90A HMAC_DRBG
+	int hlen;								//  32 (SHA2-256) or 64 (SHA2-512)
+	uint8_t k[64], v[64];					//  K and V
+	hmac_sha2_256_key_t k256;				//  midstates of K
+	hmac_sha2_512_key_t k512;
+	uint64_t rc, rci;						//  reseed counter and interval
+} hmac_drbg_t;
+
+//  Instantiate with SHA2-256 (hlen = 32) or SHA2-512 (hlen = 64) from
+//  entropy input, nonce, and personalization string. Returns 0, or -1 if
+//  "hlen" is not supported. The reseed interval "rci" may be lowered after
+//  this. An instance has no shared state; give each thread its own.
+int hash_drbg_init(hash_drbg_t * d, int hlen,
+				   const void *ent, size_t entlen,
+				   const void *nonce, size_t noncelen,
+				   const void *pers, size_t perslen);
+int hmac_drbg_init(hmac_drbg_t * d, int hlen,
+				   const void *ent, size_t entlen,
+				   const void *nonce, size_t noncelen,
+				   const void *pers, size_t perslen);
+
+//  Reseed with fresh entropy input and additional input.
+void hash_drbg_reseed(hash_drbg_t * d, const void *ent, size_t entlen,
+					  const void *add, size_t addlen);
+void hmac_drbg_reseed(hmac_drbg_t * d, const void *ent, size_t entlen,
+					  const void *add, size_t addlen);
+
+//  Generate "outlen" bytes (at most DRBG_MAX_REQUEST) with optional
+//  additional input. Returns 0, 1 if a reseed is required first, or -1 if
+//  the request is too large.
+int hash_drbg_generate(hash_drbg_t * d, uint8_t * out, size_t outlen,
+					   const void *add, size_t addlen);
+int hmac_drbg_generate(hmac_drbg_t * d, uint8_t * out, size_t outlen,
+					   const void *add, size_t addlen);
+
 //  === Compression Functions ===
 
-//  function pointer to the compression function used by the test wrappers
-extern void (*sha256_compress)(void *);
-extern void (*sha512_compress)(void *);
+//  function pointers to the multi-block compression functions used by the
+//  wrappers; "data" holds "nblocks" full blocks and needs no alignment
+extern void (*sha256_blocks)(uint32_t *, const uint8_t *, size_t);
+extern void (*sha512_blocks)(uint64_t *, const uint8_t *, size_t);
 
 //  SHA-256 compression function for RV32 (rv32_sha256.c)
-void rv32_sha256_compress(void *s);
+void rv32_sha256_blocks(uint32_t state[8],
+						const uint8_t * data, size_t nblocks);
 
 //  SHA-512 compression function for RV64 (rv64_sha512.c)
-void rv64_sha512_compress(void *s);
+void rv64_sha512_blocks(uint64_t state[8],
+						const uint8_t * data, size_t nblocks);
 
 //  SHA-512 compression function for RV32 (rv32_sha512.c)
+void rv32_sha512_blocks(uint64_t state[8],
+						const uint8_t * data, size_t nblocks);
+
+//  the same with a carry-setting ADD and ADC pair (sha2_rv32_cf512adc.c)
+void rv32_sha512_blocks_adc(uint64_t state[8],
+							const uint8_t * data, size_t nblocks);
+
+#if defined(__riscv) && (__riscv_xlen == 32) && \
+	defined(__riscv_zknh) && defined(__riscv_zbkb)
+//  hand-allocated RV32 Zknh assembly (sha2_rv32_asm.S)
+void rv32_sha512_blocks_asm(uint64_t state[8],
+							const uint8_t * data, size_t nblocks);
+#endif
+
+//  ADD, SLTU, and ADC instructions in 64-bit additions of the two RV32
+//  SHA-512 variants (emulation), and their critical path per block:
+//  "adc" 0 for ADD, SLTU, 1 for ADD, ADC with a renamed carry, 2 for ADD,
+//  ADC with a single carry register that orders the pairs
+extern unsigned long rv32_sha512_add, rv32_sha512_sltu, rv32_sha512_adc;
+int rv32_sha512_cpath(int adc);
+
+//  SHA-512 round constants and sigma functions (sha2_rv64_cf512.c)
+extern const uint64_t sha512_k[80];
+uint64_t sha512_sum0(uint64_t rs1);
+uint64_t sha512_sum1(uint64_t rs1);
+uint64_t sha512_sig0(uint64_t rs1);
+uint64_t sha512_sig1(uint64_t rs1);
+
+//  SHA-512 sigma functions on 32-bit halves (sha2_rv32_cf512.c)
+uint32_t sha512_sum0l(uint32_t rs1, uint32_t rs2);
+uint32_t sha512_sum1l(uint32_t rs1, uint32_t rs2);
+uint32_t sha512_sig0l(uint32_t rs1, uint32_t rs2);
+uint32_t sha512_sig0h(uint32_t rs1, uint32_t rs2);
+uint32_t sha512_sig1l(uint32_t rs1, uint32_t rs2);
+uint32_t sha512_sig1h(uint32_t rs1, uint32_t rs2);
+
+//  two independent block sequences of equal length, stitched
+extern void (*sha256_blocks_x2)(uint32_t *, const uint8_t *,
+								uint32_t *, const uint8_t *, size_t);
+
+//  SHA-256 two-way stitched compression (sha2_rv32_cf256x2.c)
+void rv32_sha256_blocks_x2(uint32_t state0[8], const uint8_t * data0,
+						   uint32_t state1[8], const uint8_t * data1,
+						   size_t nblocks);
+
+//  SHA-256 of two messages packed in 64-bit registers (sha2_rv64_cf256x2.c)
+void rv64_sha256_blocks_x2(uint32_t state0[8], const uint8_t * data0,
+						   uint32_t state1[8], const uint8_t * data1,
+						   size_t nblocks);
+
+//  paired 32-bit ADD32 and SHA-256 sigma functions on both halves
+uint64_t rv64_add32(uint64_t rs1, uint64_t rs2);
+uint64_t sha256_sum0p(uint64_t rs1);
+uint64_t sha256_sum1p(uint64_t rs1);
+uint64_t sha256_sig0p(uint64_t rs1);
+uint64_t sha256_sig1p(uint64_t rs1);
+
+//  ADD32, paired SHA, logic, load, and pack/unpack instructions executed by
+//  rv64_sha256_blocks_x2() (emulation)
+extern unsigned long rv64_sha256x2_add, rv64_sha256x2_sha,
+	rv64_sha256x2_logic, rv64_sha256x2_ld, rv64_sha256x2_pack;
+
+#ifdef __SSE2__
+//  x86-64, message schedule in SSE2 or AVX2 registers (sha2_x86_sched.c)
+void x86_sha256_blocks(uint32_t state[8],
+					   const uint8_t * data, size_t nblocks);
+void x86_sha512_blocks(uint64_t state[8],
+					   const uint8_t * data, size_t nblocks);
+#endif
+
+//  SHA-256 round constants and sigma functions (sha2_rv32_cf256.c)
+extern const uint32_t sha256_k[64];
+uint32_t sha256_sum0(uint32_t rs1);
+uint32_t sha256_sum1(uint32_t rs1);
+uint32_t sha256_sig0(uint32_t rs1);
+uint32_t sha256_sig1(uint32_t rs1);
+
+//  The same constants as a list K(0x428A2F98), K(0x71374491), .. for
+//  tables built at compile time from them
+#define SHA256_K_LIST(K) \
+	K(0x428A2F98), K(0x71374491), K(0xB5C0FBCF), K(0xE9B5DBA5), \
+	K(0x3956C25B), K(0x59F111F1), K(0x923F82A4), K(0xAB1C5ED5), \
+	K(0xD807AA98), K(0x12835B01), K(0x243185BE), K(0x550C7DC3), \
+	K(0x72BE5D74), K(0x80DEB1FE), K(0x9BDC06A7), K(0xC19BF174), \
+	K(0xE49B69C1), K(0xEFBE4786), K(0x0FC19DC6), K(0x240CA1CC), \
+	K(0x2DE92C6F), K(0x4A7484AA), K(0x5CB0A9DC), K(0x76F988DA), \
+	K(0x983E5152), K(0xA831C66D), K(0xB00327C8), K(0xBF597FC7), \
+	K(0xC6E00BF3), K(0xD5A79147), K(0x06CA6351), K(0x14292967), \
+	K(0x27B70A85), K(0x2E1B2138), K(0x4D2C6DFC), K(0x53380D13), \
+	K(0x650A7354), K(0x766A0ABB), K(0x81C2C92E), K(0x92722C85), \
+	K(0xA2BFE8A1), K(0xA81A664B), K(0xC24B8B70), K(0xC76C51A3), \
+	K(0xD192E819), K(0xD6990624), K(0xF40E3585), K(0x106AA070), \
+	K(0x19A4C116), K(0x1E376C08), K(0x2748774C), K(0x34B0BCB5), \
+	K(0x391C0CB3), K(0x4ED8AA4A), K(0x5B9CCA4F), K(0x682E6FF3), \
+	K(0x748F82EE), K(0x78A5636F), K(0x84C87814), K(0x8CC70208), \
+	K(0x90BEFFFA), K(0xA4506CEB), K(0xBEF9A3F7), K(0xC67178F2)
+
+//  single block, state s[0..7] followed by the block (same files)
+void rv32_sha256_compress(void *s);
+void rv64_sha512_compress(void *s);
 void rv32_sha512_compress(void *s);
 
 #endif
@@ -0,0 +1,322 @@
+//  sha2_x86_mb.c
+//  2020-03-12  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  Multi-buffer SHA2-256 and SHA2-512 lane kernels for AVX2 and AVX-512:
+//  each 32-bit (SHA2-256) or 64-bit (SHA2-512) vector lane is a separate
+//  state, so the rounds are exactly the scalar ones on vectors. The
+//  message words are transposed with scalar loads. State word i of lane j
+//  is s[lanes * i + j]; lanes without a "mask" bit keep their state.
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+
+#include <immintrin.h>
+
+#include "sha2_wrap.h"
+#include "rv_endian.h"
+
+//  generic round and schedule step over vector macros ADD, XOR, AND, OR,
+//  ROR, SHR, CH, MAJ, and SET1 (broadcast constant)
+
+#define MB_ROUND(k, wt) {											\
+	x = ADD(ADD(h, ADD(SUM1(e), CH(e, f, g))), ADD(SET1(k), wt));	\
+	h = g;															\
+	g = f;															\
+	f = e;															\
+	e = ADD(d, x);													\
+	d = c;															\
+	c = b;															\
+	b = a;															\
+	a = ADD(x, ADD(SUM0(b), MAJ(b, c, d)));							}
+
+#define MB_SCHED(t) {												\
+	w[t & 15] = ADD(ADD(w[t & 15], SIG0(w[(t + 1) & 15])),			\
+					ADD(w[(t + 9) & 15], SIG1(w[(t + 14) & 15])));	}
+
+#ifdef __AVX2__
+
+//  === AVX2 ===
+
+#define ADD(a, b)	_mm256_add_epi32(a, b)
+#define XOR(a, b)	_mm256_xor_si256(a, b)
+#define ROR(a, n)	_mm256_or_si256(_mm256_srli_epi32(a, n),		\
+						_mm256_slli_epi32(a, 32 - (n)))
+#define SHR(a, n)	_mm256_srli_epi32(a, n)
+#define CH(e, f, g) XOR(g, _mm256_and_si256(e, XOR(f, g)))
+#define MAJ(b, c, d) _mm256_or_si256(_mm256_and_si256(				\
+						_mm256_or_si256(b, d), c), _mm256_and_si256(d, b))
+#define SET1(k)		_mm256_set1_epi32(k)
+#define SUM0(x)		XOR(XOR(ROR(x, 2), ROR(x, 13)), ROR(x, 22))
+#define SUM1(x)		XOR(XOR(ROR(x, 6), ROR(x, 11)), ROR(x, 25))
+#define SIG0(x)		XOR(XOR(ROR(x, 7), ROR(x, 18)), SHR(x, 3))
+#define SIG1(x)		XOR(XOR(ROR(x, 17), ROR(x, 19)), SHR(x, 10))
+
+//  per-lane mask from bits
+#define LANEMASK32X8(m) _mm256_cmpeq_epi32(_mm256_and_si256(		\
+	_mm256_set1_epi32(m), _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128)), \
+	_mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128))
+
+void avx2_sha256_x8(uint32_t * s, const uint8_t * const blk[], uint32_t mask)
+{
+	int i, j, t;
+	uint32_t wt[16][8] __attribute__((aligned(32)));
+	__m256i a, b, c, d, e, f, g, h, x, m, v[8], w[16];
+
+	for (i = 0; i < 16; i++)				//  transpose
+		for (j = 0; j < 8; j++)
+			wt[i][j] = ld32u_be(blk[j] + 4 * i);
+	for (i = 0; i < 16; i++)
+		w[i] = _mm256_load_si256((const __m256i *) wt[i]);
+	for (i = 0; i < 8; i++)
+		v[i] = _mm256_loadu_si256((const __m256i *) (s + 8 * i));
+
+	a = v[0];
+	b = v[1];
+	c = v[2];
+	d = v[3];
+	e = v[4];
+	f = v[5];
+	g = v[6];
+	h = v[7];
+
+	for (t = 0; t < 64; t++) {
+		if (t >= 16)
+			MB_SCHED(t);
+		MB_ROUND(sha256_k[t], w[t & 15]);
+	}
+
+	m = LANEMASK32X8(mask);					//  feed-forward where masked
+	_mm256_storeu_si256((__m256i *) (s), _mm256_blendv_epi8(v[0],
+						ADD(v[0], a), m));
+	_mm256_storeu_si256((__m256i *) (s + 8), _mm256_blendv_epi8(v[1],
+						ADD(v[1], b), m));
+	_mm256_storeu_si256((__m256i *) (s + 16), _mm256_blendv_epi8(v[2],
+						ADD(v[2], c), m));
+	_mm256_storeu_si256((__m256i *) (s + 24), _mm256_blendv_epi8(v[3],
+						ADD(v[3], d), m));
+	_mm256_storeu_si256((__m256i *) (s + 32), _mm256_blendv_epi8(v[4],
+						ADD(v[4], e), m));
+	_mm256_storeu_si256((__m256i *) (s + 40), _mm256_blendv_epi8(v[5],
+						ADD(v[5], f), m));
+	_mm256_storeu_si256((__m256i *) (s + 48), _mm256_blendv_epi8(v[6],
+						ADD(v[6], g), m));
+	_mm256_storeu_si256((__m256i *) (s + 56), _mm256_blendv_epi8(v[7],
+						ADD(v[7], h), m));
+}
+
+#undef ADD
+#undef ROR
+#undef SHR
+#undef SET1
+#undef SUM0
+#undef SUM1
+#undef SIG0
+#undef SIG1
+
+#define ADD(a, b)	_mm256_add_epi64(a, b)
+#define ROR(a, n)	_mm256_or_si256(_mm256_srli_epi64(a, n),		\
+						_mm256_slli_epi64(a, 64 - (n)))
+#define SHR(a, n)	_mm256_srli_epi64(a, n)
+#define SET1(k)		_mm256_set1_epi64x(k)
+#define SUM0(x)		XOR(XOR(ROR(x, 28), ROR(x, 34)), ROR(x, 39))
+#define SUM1(x)		XOR(XOR(ROR(x, 14), ROR(x, 18)), ROR(x, 41))
+#define SIG0(x)		XOR(XOR(ROR(x, 1), ROR(x, 8)), SHR(x, 7))
+#define SIG1(x)		XOR(XOR(ROR(x, 19), ROR(x, 61)), SHR(x, 6))
+
+#define LANEMASK64X4(m) _mm256_cmpeq_epi64(_mm256_and_si256(		\
+	_mm256_set1_epi64x(m), _mm256_setr_epi64x(1, 2, 4, 8)),			\
+	_mm256_setr_epi64x(1, 2, 4, 8))
+
+void avx2_sha512_x4(uint64_t * s, const uint8_t * const blk[], uint32_t mask)
+{
+	int i, j, t;
+	uint64_t wt[16][4] __attribute__((aligned(32)));
+	__m256i a, b, c, d, e, f, g, h, x, m, v[8], w[16];
+
+	for (i = 0; i < 16; i++)				//  transpose
+		for (j = 0; j < 4; j++)
+			wt[i][j] = ld64u_be(blk[j] + 8 * i);
+	for (i = 0; i < 16; i++)
+		w[i] = _mm256_load_si256((const __m256i *) wt[i]);
+	for (i = 0; i < 8; i++)
+		v[i] = _mm256_loadu_si256((const __m256i *) (s + 4 * i));
+
+	a = v[0];
+	b = v[1];
+	c = v[2];
+	d = v[3];
+	e = v[4];
+	f = v[5];
+	g = v[6];
+	h = v[7];
+
+	for (t = 0; t < 80; t++) {
+		if (t >= 16)
+			MB_SCHED(t);
+		MB_ROUND(sha512_k[t], w[t & 15]);
+	}
+
+	m = LANEMASK64X4(mask);					//  feed-forward where masked
+	_mm256_storeu_si256((__m256i *) (s), _mm256_blendv_epi8(v[0],
+						ADD(v[0], a), m));
+	_mm256_storeu_si256((__m256i *) (s + 4), _mm256_blendv_epi8(v[1],
+						ADD(v[1], b), m));
+	_mm256_storeu_si256((__m256i *) (s + 8), _mm256_blendv_epi8(v[2],
+						ADD(v[2], c), m));
+	_mm256_storeu_si256((__m256i *) (s + 12), _mm256_blendv_epi8(v[3],
+						ADD(v[3], d), m));
+	_mm256_storeu_si256((__m256i *) (s + 16), _mm256_blendv_epi8(v[4],
+						ADD(v[4], e), m));
+	_mm256_storeu_si256((__m256i *) (s + 20), _mm256_blendv_epi8(v[5],
+						ADD(v[5], f), m));
+	_mm256_storeu_si256((__m256i *) (s + 24), _mm256_blendv_epi8(v[6],
+						ADD(v[6], g), m));
+	_mm256_storeu_si256((__m256i *) (s + 28), _mm256_blendv_epi8(v[7],
+						ADD(v[7], h), m));
+}
+
+#undef ADD
+#undef XOR
+#undef ROR
+#undef SHR
+#undef CH
+#undef MAJ
+#undef SET1
+#undef SUM0
+#undef SUM1
+#undef SIG0
+#undef SIG1
+
+#endif
+
+#ifdef __AVX512F__
+
+//  === AVX-512: native rotates, ternary logic for Ch and Maj, masked add ===
+
+#define ADD(a, b)	_mm512_add_epi32(a, b)
+#define XOR(a, b)	_mm512_xor_si512(a, b)
+#define ROR(a, n)	_mm512_ror_epi32(a, n)
+#define SHR(a, n)	_mm512_srli_epi32(a, n)
+#define CH(e, f, g) _mm512_ternarylogic_epi32(e, f, g, 0xCA)
+#define MAJ(b, c, d) _mm512_ternarylogic_epi32(b, c, d, 0xE8)
+#define SET1(k)		_mm512_set1_epi32(k)
+#define SUM0(x)		_mm512_ternarylogic_epi32(ROR(x, 2), ROR(x, 13),	\
+						ROR(x, 22), 0x96)
+#define SUM1(x)		_mm512_ternarylogic_epi32(ROR(x, 6), ROR(x, 11),	\
+						ROR(x, 25), 0x96)
+#define SIG0(x)		_mm512_ternarylogic_epi32(ROR(x, 7), ROR(x, 18),	\
+						SHR(x, 3), 0x96)
+#define SIG1(x)		_mm512_ternarylogic_epi32(ROR(x, 17), ROR(x, 19),	\
+						SHR(x, 10), 0x96)
+
+void avx512_sha256_x16(uint32_t * s, const uint8_t * const blk[],
+					   uint32_t mask)
+{
+	int i, j, t;
+	uint32_t wt[16][16] __attribute__((aligned(64)));
+	__m512i a, b, c, d, e, f, g, h, x, v[8], w[16];
+	__mmask16 m = (__mmask16) mask;
+
+	for (i = 0; i < 16; i++)				//  transpose
+		for (j = 0; j < 16; j++)
+			wt[i][j] = ld32u_be(blk[j] + 4 * i);
+	for (i = 0; i < 16; i++)
+		w[i] = _mm512_load_si512(wt[i]);
+	for (i = 0; i < 8; i++)
+		v[i] = _mm512_loadu_si512(s + 16 * i);
+
+	a = v[0];
+	b = v[1];
+	c = v[2];
+	d = v[3];
+	e = v[4];
+	f = v[5];
+	g = v[6];
+	h = v[7];
+
+	for (t = 0; t < 64; t++) {
+		if (t >= 16)
+			MB_SCHED(t);
+		MB_ROUND(sha256_k[t], w[t & 15]);
+	}
+
+	_mm512_storeu_si512(s, _mm512_mask_add_epi32(v[0], m, v[0], a));
+	_mm512_storeu_si512(s + 16, _mm512_mask_add_epi32(v[1], m, v[1], b));
+	_mm512_storeu_si512(s + 32, _mm512_mask_add_epi32(v[2], m, v[2], c));
+	_mm512_storeu_si512(s + 48, _mm512_mask_add_epi32(v[3], m, v[3], d));
+	_mm512_storeu_si512(s + 64, _mm512_mask_add_epi32(v[4], m, v[4], e));
+	_mm512_storeu_si512(s + 80, _mm512_mask_add_epi32(v[5], m, v[5], f));
+	_mm512_storeu_si512(s + 96, _mm512_mask_add_epi32(v[6], m, v[6], g));
+	_mm512_storeu_si512(s + 112, _mm512_mask_add_epi32(v[7], m, v[7], h));
+}
+
+#undef ADD
+#undef ROR
+#undef SHR
+#undef CH
+#undef MAJ
+#undef SET1
+#undef SUM0
+#undef SUM1
+#undef SIG0
+#undef SIG1
+
+#define ADD(a, b)	_mm512_add_epi64(a, b)
+#define ROR(a, n)	_mm512_ror_epi64(a, n)
+#define SHR(a, n)	_mm512_srli_epi64(a, n)
+#define CH(e, f, g) _mm512_ternarylogic_epi64(e, f, g, 0xCA)
+#define MAJ(b, c, d) _mm512_ternarylogic_epi64(b, c, d, 0xE8)
+#define SET1(k)		_mm512_set1_epi64(k)
+#define SUM0(x)		_mm512_ternarylogic_epi64(ROR(x, 28), ROR(x, 34),	\
+						ROR(x, 39), 0x96)
+#define SUM1(x)		_mm512_ternarylogic_epi64(ROR(x, 14), ROR(x, 18),	\
+						ROR(x, 41), 0x96)
+#define SIG0(x)		_mm512_ternarylogic_epi64(ROR(x, 1), ROR(x, 8),	\
+						SHR(x, 7), 0x96)
+#define SIG1(x)		_mm512_ternarylogic_epi64(ROR(x, 19), ROR(x, 61),	\
+						SHR(x, 6), 0x96)
+
+void avx512_sha512_x8(uint64_t * s, const uint8_t * const blk[],
+					  uint32_t mask)
+{
+	int i, j, t;
+	uint64_t wt[16][8] __attribute__((aligned(64)));
+	__m512i a, b, c, d, e, f, g, h, x, v[8], w[16];
+	__mmask8 m = (__mmask8) mask;
+
+	for (i = 0; i < 16; i++)				//  transpose
+		for (j = 0; j < 8; j++)
+			wt[i][j] = ld64u_be(blk[j] + 8 * i);
+	for (i = 0; i < 16; i++)
+		w[i] = _mm512_load_si512(wt[i]);
+	for (i = 0; i < 8; i++)
+		v[i] = _mm512_loadu_si512(s + 8 * i);
+
+	a = v[0];
+	b = v[1];
+	c = v[2];
+	d = v[3];
+	e = v[4];
+	f = v[5];
+	g = v[6];
+	h = v[7];
+
+	for (t = 0; t < 80; t++) {
+		if (t >= 16)
+			MB_SCHED(t);
+		MB_ROUND(sha512_k[t], w[t & 15]);
+	}
+
+	_mm512_storeu_si512(s, _mm512_mask_add_epi64(v[0], m, v[0], a));
+	_mm512_storeu_si512(s + 8, _mm512_mask_add_epi64(v[1], m, v[1], b));
+	_mm512_storeu_si512(s + 16, _mm512_mask_add_epi64(v[2], m, v[2], c));
+	_mm512_storeu_si512(s + 24, _mm512_mask_add_epi64(v[3], m, v[3], d));
+	_mm512_storeu_si512(s + 32, _mm512_mask_add_epi64(v[4], m, v[4], e));
+	_mm512_storeu_si512(s + 40, _mm512_mask_add_epi64(v[5], m, v[5], f));
+	_mm512_storeu_si512(s + 48, _mm512_mask_add_epi64(v[6], m, v[6], g));
+	_mm512_storeu_si512(s + 56, _mm512_mask_add_epi64(v[7], m, v[7], h));
+}
+
+#endif
+
+#endif
@@ -0,0 +1,355 @@
+//  sha2_x86_sched.c
+//  2020-03-12  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  FIPS 180-4 SHA2-256 and SHA2-512 compression for x86-64 with the message
+//  schedule in vector registers. W[t] + K[t] of a whole block is computed
+//  into an aligned buffer ahead of the rounds, which are then scalar with a
+//  single load and add for the message. SSE2 (every x86-64) computes four
+//  SHA2-256 or two SHA2-512 words per step; with AVX2 the two 128-bit
+//  halves schedule two SHA2-256 blocks at once and SHA2-512 takes four
+//  words per step.
+
+#ifdef __SSE2__
+
+#include <emmintrin.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "sha2_wrap.h"
+#include "rv_endian.h"
+
+//  scalar rotates for the rounds
+
+static inline uint32_t ror32(uint32_t x, int n)
+{
+	return (x >> n) | (x << (32 - n));
+}
+
+static inline uint64_t ror64(uint64_t x, int n)
+{
+	return (x >> n) | (x << (64 - n));
+}
+
+//  64 SHA2-256 rounds with a ready W[t] + K[t]
+
+static inline void sha256r(uint32_t v[8], const uint32_t wk[64])
+{
+	int t;
+	uint32_t a, b, c, d, e, f, g, h, x;
+
+	a = v[0];
+	b = v[1];
+	c = v[2];
+	d = v[3];
+	e = v[4];
+	f = v[5];
+	g = v[6];
+	h = v[7];
+
+	for (t = 0; t < 64; t++) {
+		x = h + (ror32(e, 6) ^ ror32(e, 11) ^ ror32(e, 25)) +
+			(g ^ (e & (f ^ g))) + wk[t];
+		h = g;
+		g = f;
+		f = e;
+		e = d + x;
+		d = c;
+		c = b;
+		b = a;
+		a = x + (ror32(b, 2) ^ ror32(b, 13) ^ ror32(b, 22)) +
+			(((b | d) & c) | (d & b));
+	}
+
+	v[0] += a;
+	v[1] += b;
+	v[2] += c;
+	v[3] += d;
+	v[4] += e;
+	v[5] += f;
+	v[6] += g;
+	v[7] += h;
+}
+
+//  80 SHA2-512 rounds with a ready W[t] + K[t]
+
+static inline void sha512r(uint64_t v[8], const uint64_t wk[80])
+{
+	int t;
+	uint64_t a, b, c, d, e, f, g, h, x;
+
+	a = v[0];
+	b = v[1];
+	c = v[2];
+	d = v[3];
+	e = v[4];
+	f = v[5];
+	g = v[6];
+	h = v[7];
+
+	for (t = 0; t < 80; t++) {
+		x = h + (ror64(e, 14) ^ ror64(e, 18) ^ ror64(e, 41)) +
+			(g ^ (e & (f ^ g))) + wk[t];
+		h = g;
+		g = f;
+		f = e;
+		e = d + x;
+		d = c;
+		c = b;
+		b = a;
+		a = x + (ror64(b, 28) ^ ror64(b, 34) ^ ror64(b, 39)) +
+			(((b | d) & c) | (d & b));
+	}
+
+	v[0] += a;
+	v[1] += b;
+	v[2] += c;
+	v[3] += d;
+	v[4] += e;
+	v[5] += f;
+	v[6] += g;
+	v[7] += h;
+}
+
+//  === SHA2-256 ===
+
+//  SSE2 has no byte shuffle: swap bytes of 16-bit halves, then the halves
+
+#define BSWAP32X4(x) _mm_shufflehi_epi16(_mm_shufflelo_epi16(		\
+	_mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8)),		\
+	0xB1), 0xB1)
+
+#define ROR32X4(x, n) _mm_or_si128(_mm_srli_epi32(x, n),			\
+	_mm_slli_epi32(x, 32 - (n)))
+
+#define SIG0X4(x) _mm_xor_si128(_mm_xor_si128(ROR32X4(x, 7),		\
+	ROR32X4(x, 18)), _mm_srli_epi32(x, 3))
+
+#define SIG1X4(x) _mm_xor_si128(_mm_xor_si128(ROR32X4(x, 17),		\
+	ROR32X4(x, 19)), _mm_srli_epi32(x, 10))
+
+//  words 1..4 of the 8 words in (lo, hi)
+#define NEXT32X4(lo, hi) _mm_or_si128(_mm_srli_si128(lo, 4),		\
+	_mm_slli_si128(hi, 12))
+
+//  W[16..63] + K of one block; w0..w3 hold W[t - 16 .. t - 1]. sig1() of
+//  the first two new words needs only W[t - 2], W[t - 1]; the other two
+//  need the first two.
+
+static void sha256sched_x4(uint32_t wk[64], const uint8_t * data)
+{
+	int t;
+	__m128i w0, w1, w2, w3, x;
+
+	w0 = BSWAP32X4(_mm_loadu_si128((const __m128i *) data));
+	w1 = BSWAP32X4(_mm_loadu_si128((const __m128i *) (data + 16)));
+	w2 = BSWAP32X4(_mm_loadu_si128((const __m128i *) (data + 32)));
+	w3 = BSWAP32X4(_mm_loadu_si128((const __m128i *) (data + 48)));
+
+	for (t = 0; t < 64; t += 4) {
+		_mm_store_si128((__m128i *) & wk[t], _mm_add_epi32(w0,
+						_mm_loadu_si128((const __m128i *) &sha256_k[t])));
+
+		x = _mm_add_epi32(w0, SIG0X4(NEXT32X4(w0, w1)));
+		x = _mm_add_epi32(x, NEXT32X4(w2, w3));
+		x = _mm_add_epi32(x, SIG1X4(_mm_srli_si128(w3, 8)));
+		x = _mm_add_epi32(x, SIG1X4(_mm_slli_si128(x, 8)));
+
+		w0 = w1;
+		w1 = w2;
+		w2 = w3;
+		w3 = x;
+	}
+}
+
+#ifdef __AVX2__
+
+//  the same for two consecutive blocks, one in each 128-bit half; the
+//  byte shifts of AVX2 do not cross the halves
+
+#define BSWAP32X8(x) _mm256_shuffle_epi8(x, _mm256_set_epi8(		\
+	12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,			\
+	12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3))
+
+#define ROR32X8(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n),		\
+	_mm256_slli_epi32(x, 32 - (n)))
+
+#define SIG0X8(x) _mm256_xor_si256(_mm256_xor_si256(ROR32X8(x, 7),	\
+	ROR32X8(x, 18)), _mm256_srli_epi32(x, 3))
+
+#define SIG1X8(x) _mm256_xor_si256(_mm256_xor_si256(ROR32X8(x, 17),	\
+	ROR32X8(x, 19)), _mm256_srli_epi32(x, 10))
+
+#define NEXT32X8(lo, hi) _mm256_alignr_epi8(hi, lo, 4)
+
+#define LOAD2X128(p0, p1) _mm256_inserti128_si256(					\
+	_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) (p0))),	\
+	_mm_loadu_si128((const __m128i *) (p1)), 1)
+
+static void sha256sched_x8(uint32_t wk[2][64], const uint8_t * data)
+{
+	int t;
+	__m256i w0, w1, w2, w3, x, k;
+
+	w0 = BSWAP32X8(LOAD2X128(data, data + 64));
+	w1 = BSWAP32X8(LOAD2X128(data + 16, data + 80));
+	w2 = BSWAP32X8(LOAD2X128(data + 32, data + 96));
+	w3 = BSWAP32X8(LOAD2X128(data + 48, data + 112));
+
+	for (t = 0; t < 64; t += 4) {
+		k = _mm256_broadcastsi128_si256(
+				_mm_loadu_si128((const __m128i *) &sha256_k[t]));
+		x = _mm256_add_epi32(w0, k);
+		_mm_store_si128((__m128i *) & wk[0][t],
+						_mm256_castsi256_si128(x));
+		_mm_store_si128((__m128i *) & wk[1][t],
+						_mm256_extracti128_si256(x, 1));
+
+		x = _mm256_add_epi32(w0, SIG0X8(NEXT32X8(w0, w1)));
+		x = _mm256_add_epi32(x, NEXT32X8(w2, w3));
+		x = _mm256_add_epi32(x, SIG1X8(_mm256_srli_si256(w3, 8)));
+		x = _mm256_add_epi32(x, SIG1X8(_mm256_slli_si256(x, 8)));
+
+		w0 = w1;
+		w1 = w2;
+		w2 = w3;
+		w3 = x;
+	}
+}
+
+#endif
+
+//  compress "nblocks" 64-byte blocks from "data" (any alignment)
+
+void x86_sha256_blocks(uint32_t state[8],
+					   const uint8_t * data, size_t nblocks)
+{
+#ifdef __AVX2__
+	uint32_t wk[2][64] __attribute__((aligned(32)));
+
+	for (; nblocks >= 2; nblocks -= 2) {
+		sha256sched_x8(wk, data);
+		sha256r(state, wk[0]);
+		sha256r(state, wk[1]);
+		data += 128;
+	}
+#else
+	uint32_t wk[1][64] __attribute__((aligned(16)));
+#endif
+
+	for (; nblocks > 0; nblocks--) {
+		sha256sched_x4(wk[0], data);
+		sha256r(state, wk[0]);
+		data += 64;
+	}
+}
+
+//  === SHA2-512 ===
+
+#ifndef __AVX2__
+
+//  SSE2: two words per step, which only need the previous two for sig1()
+
+#define BSWAP64X2(x) _mm_shufflehi_epi16(_mm_shufflelo_epi16(		\
+	_mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8)),		\
+	0x1B), 0x1B)
+
+#define ROR64X2(x, n) _mm_or_si128(_mm_srli_epi64(x, n),			\
+	_mm_slli_epi64(x, 64 - (n)))
+
+#define SIG0X2(x) _mm_xor_si128(_mm_xor_si128(ROR64X2(x, 1),		\
+	ROR64X2(x, 8)), _mm_srli_epi64(x, 7))
+
+#define SIG1X2(x) _mm_xor_si128(_mm_xor_si128(ROR64X2(x, 19),		\
+	ROR64X2(x, 61)), _mm_srli_epi64(x, 6))
+
+#define NEXT64X2(lo, hi) _mm_or_si128(_mm_srli_si128(lo, 8),		\
+	_mm_slli_si128(hi, 8))
+
+static void sha512sched(uint64_t wk[80], const uint8_t * data)
+{
+	int i, t;
+	__m128i w[8], x;
+
+	for (i = 0; i < 8; i++)
+		w[i] = BSWAP64X2(_mm_loadu_si128((const __m128i *) (data + 16 * i)));
+
+	for (t = 0; t < 80; t += 2) {
+		i = (t >> 1) & 7;					//  w[i] is W[t - 16 .. t - 15]
+		_mm_store_si128((__m128i *) & wk[t], _mm_add_epi64(w[i],
+						_mm_load_si128((const __m128i *) &sha512_k[t])));
+
+		x = _mm_add_epi64(w[i], SIG0X2(NEXT64X2(w[i], w[(i + 1) & 7])));
+		x = _mm_add_epi64(x, NEXT64X2(w[(i + 4) & 7], w[(i + 5) & 7]));
+		x = _mm_add_epi64(x, SIG1X2(w[(i + 7) & 7]));
+		w[i] = x;
+	}
+}
+
+#else
+
+//  AVX2: four words per step, split in two halves as with SHA2-256
+
+#define BSWAP64X4(x) _mm256_shuffle_epi8(x, _mm256_set_epi8(		\
+	8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7,			\
+	8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7))
+
+#define ROR64X4(x, n) _mm256_or_si256(_mm256_srli_epi64(x, n),		\
+	_mm256_slli_epi64(x, 64 - (n)))
+
+#define SIG0X4_64(x) _mm256_xor_si256(_mm256_xor_si256(				\
+	ROR64X4(x, 1), ROR64X4(x, 8)), _mm256_srli_epi64(x, 7))
+
+#define SIG1X4_64(x) _mm256_xor_si256(_mm256_xor_si256(				\
+	ROR64X4(x, 19), ROR64X4(x, 61)), _mm256_srli_epi64(x, 6))
+
+//  words 1..4 of the 8 words in (lo, hi)
+#define NEXT64X4(lo, hi) _mm256_permute4x64_epi64(					\
+	_mm256_blend_epi32(lo, hi, 0x03), 0x39)
+
+static void sha512sched(uint64_t wk[80], const uint8_t * data)
+{
+	int i, t;
+	__m256i w[4], x, z;
+
+	z = _mm256_setzero_si256();
+	for (i = 0; i < 4; i++)
+		w[i] = BSWAP64X4(_mm256_loadu_si256((const __m256i *)
+											(data + 32 * i)));
+
+	for (t = 0; t < 80; t += 4) {
+		i = (t >> 2) & 3;					//  w[i] is W[t - 16 .. t - 13]
+		_mm256_store_si256((__m256i *) & wk[t], _mm256_add_epi64(w[i],
+						   _mm256_load_si256((const __m256i *)
+											 &sha512_k[t])));
+
+		x = _mm256_add_epi64(w[i],
+							 SIG0X4_64(NEXT64X4(w[i], w[(i + 1) & 3])));
+		x = _mm256_add_epi64(x, NEXT64X4(w[(i + 2) & 3], w[(i + 3) & 3]));
+		x = _mm256_add_epi64(x, SIG1X4_64(_mm256_blend_epi32(z,
+							 _mm256_permute4x64_epi64(w[(i + 3) & 3],
+													  0xEE), 0x0F)));
+		x = _mm256_add_epi64(x, SIG1X4_64(_mm256_blend_epi32(
+							 _mm256_permute4x64_epi64(x, 0x40), z, 0x0F)));
+		w[i] = x;
+	}
+}
+
+#endif
+
+//  compress "nblocks" 128-byte blocks from "data" (any alignment)
+
+void x86_sha512_blocks(uint64_t state[8],
+					   const uint8_t * data, size_t nblocks)
+{
+	uint64_t wk[80] __attribute__((aligned(32)));
+
+	for (; nblocks > 0; nblocks--) {
+		sha512sched(wk, data);
+		sha512r(state, wk);
+		data += 128;
+	}
+}
+
+#endif
@@ -0,0 +1,205 @@
+//  sha3_arm_keccakp.c
+//  2020-03-05  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  FIPS 202 Keccak permutation for ARMv8.2-A with the SHA3 extension.
+//  Two states are processed at once, one in each 64-bit half of the
+//  128-bit registers. EOR3 computes the column parities, RAX1 the D words,
+//  XAR does Theta's XOR and the Rho rotation at once, and BCAX is Chi.
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_SHA3)
+
+#include <arm_neon.h>
+
+#include "sha3_wrap.h"
+
+//  load lane "i" of both states, store it back
+
+#define LOAD2(i)		vcombine_u64(vld1_u64(&v0[i]), vld1_u64(&v1[i]))
+#define STORE2(i, x)	{ vst1_u64(&v0[i], vget_low_u64(x));	\
+						  vst1_u64(&v1[i], vget_high_u64(x)); }
+
+//  Keccak-p[1600,24](S) on two states (which may be the same)
+
+void arm_keccakp_x2(void *s0, void *s1)
+{
+	//  round constants
+	const uint64_t rc[24] = {
+		0x0000000000000001LL, 0x0000000000008082LL, 0x800000000000808ALL,
+		0x8000000080008000LL, 0x000000000000808BLL, 0x0000000080000001LL,
+		0x8000000080008081LL, 0x8000000000008009LL, 0x000000000000008ALL,
+		0x0000000000000088LL, 0x0000000080008009LL, 0x000000008000000ALL,
+		0x000000008000808BLL, 0x800000000000008BLL, 0x8000000000008089LL,
+		0x8000000000008003LL, 0x8000000000008002LL, 0x8000000000000080LL,
+		0x000000000000800ALL, 0x800000008000000ALL, 0x8000000080008081LL,
+		0x8000000000008080LL, 0x0000000080000001LL, 0x8000000080008008LL
+	};
+
+	int i;
+	uint64x2_t t, c0, c1, c2, c3, c4, d0, d1, d2, d3, d4;
+	uint64x2_t sa, sb, sc, sd, se, sf, sg, sh, si, sj, sk, sl, sm,
+		sn, so, sp, sq, sr, ss, st, su, sv, sw, sx, sy;
+
+	uint64_t *v0 = (uint64_t *) s0;
+	uint64_t *v1 = (uint64_t *) s1;
+
+	sa = LOAD2(0);
+	sb = LOAD2(1);
+	sc = LOAD2(2);
+	sd = LOAD2(3);
+	se = LOAD2(4);
+	sf = LOAD2(5);
+	sg = LOAD2(6);
+	sh = LOAD2(7);
+	si = LOAD2(8);
+	sj = LOAD2(9);
+	sk = LOAD2(10);
+	sl = LOAD2(11);
+	sm = LOAD2(12);
+	sn = LOAD2(13);
+	so = LOAD2(14);
+	sp = LOAD2(15);
+	sq = LOAD2(16);
+	sr = LOAD2(17);
+	ss = LOAD2(18);
+	st = LOAD2(19);
+	su = LOAD2(20);
+	sv = LOAD2(21);
+	sw = LOAD2(22);
+	sx = LOAD2(23);
+	sy = LOAD2(24);
+
+	for (i = 0; i < 24; i++) {
+
+		//  Theta: parities with EOR3, D[x] = C[x - 1] ^ (C[x + 1] <<< 1)
+
+		c0 = veor3q_u64(veor3q_u64(sa, sf, sk), sp, su);
+		c1 = veor3q_u64(veor3q_u64(sb, sg, sl), sq, sv);
+		c2 = veor3q_u64(veor3q_u64(sc, sh, sm), sr, sw);
+		c3 = veor3q_u64(veor3q_u64(sd, si, sn), ss, sx);
+		c4 = veor3q_u64(veor3q_u64(se, sj, so), st, sy);
+
+		d0 = vrax1q_u64(c4, c1);
+		d1 = vrax1q_u64(c0, c2);
+		d2 = vrax1q_u64(c1, c3);
+		d3 = vrax1q_u64(c2, c4);
+		d4 = vrax1q_u64(c3, c0);
+
+		//  (Theta) Rho Pi: XAR is rotate right of the XOR
+
+		sa = veorq_u64(sa, d0);
+		t = vxarq_u64(sb, d1, 63);
+		sb = vxarq_u64(sg, d1, 20);
+		sg = vxarq_u64(sj, d4, 44);
+		sj = vxarq_u64(sw, d2, 3);
+		sw = vxarq_u64(so, d4, 25);
+		so = vxarq_u64(su, d0, 46);
+		su = vxarq_u64(sc, d2, 2);
+		sc = vxarq_u64(sm, d2, 21);
+		sm = vxarq_u64(sn, d3, 39);
+		sn = vxarq_u64(st, d4, 56);
+		st = vxarq_u64(sx, d3, 8);
+		sx = vxarq_u64(sp, d0, 23);
+		sp = vxarq_u64(se, d4, 37);
+		se = vxarq_u64(sy, d4, 50);
+		sy = vxarq_u64(sv, d1, 62);
+		sv = vxarq_u64(si, d3, 9);
+		si = vxarq_u64(sq, d1, 19);
+		sq = vxarq_u64(sf, d0, 28);
+		sf = vxarq_u64(sd, d3, 36);
+		sd = vxarq_u64(ss, d3, 43);
+		ss = vxarq_u64(sr, d2, 49);
+		sr = vxarq_u64(sl, d1, 54);
+		sl = vxarq_u64(sh, d2, 58);
+		sh = vxarq_u64(sk, d0, 61);
+		sk = t;
+
+		//  Chi: BCAX(x, y, z) = x ^ (y & ~z)
+
+		t = vbicq_u64(se, sd);
+		se = vbcaxq_u64(se, sb, sa);
+		sb = vbcaxq_u64(sb, sd, sc);
+		sd = vbcaxq_u64(sd, sa, se);
+		sa = vbcaxq_u64(sa, sc, sb);
+		sc = veorq_u64(sc, t);
+
+		t = vbicq_u64(sj, si);
+		sj = vbcaxq_u64(sj, sg, sf);
+		sg = vbcaxq_u64(sg, si, sh);
+		si = vbcaxq_u64(si, sf, sj);
+		sf = vbcaxq_u64(sf, sh, sg);
+		sh = veorq_u64(sh, t);
+
+		t = vbicq_u64(so, sn);
+		so = vbcaxq_u64(so, sl, sk);
+		sl = vbcaxq_u64(sl, sn, sm);
+		sn = vbcaxq_u64(sn, sk, so);
+		sk = vbcaxq_u64(sk, sm, sl);
+		sm = veorq_u64(sm, t);
+
+		t = vbicq_u64(st, ss);
+		st = vbcaxq_u64(st, sq, sp);
+		sq = vbcaxq_u64(sq, ss, sr);
+		ss = vbcaxq_u64(ss, sp, st);
+		sp = vbcaxq_u64(sp, sr, sq);
+		sr = veorq_u64(sr, t);
+
+		t = vbicq_u64(sy, sx);
+		sy = vbcaxq_u64(sy, sv, su);
+		sv = vbcaxq_u64(sv, sx, sw);
+		sx = vbcaxq_u64(sx, su, sy);
+		su = vbcaxq_u64(su, sw, sv);
+		sw = veorq_u64(sw, t);
+
+		//  Iota
+
+		sa = veorq_u64(sa, vdupq_n_u64(rc[i]));
+	}
+
+	STORE2(0, sa);
+	STORE2(1, sb);
+	STORE2(2, sc);
+	STORE2(3, sd);
+	STORE2(4, se);
+	STORE2(5, sf);
+	STORE2(6, sg);
+	STORE2(7, sh);
+	STORE2(8, si);
+	STORE2(9, sj);
+	STORE2(10, sk);
+	STORE2(11, sl);
+	STORE2(12, sm);
+	STORE2(13, sn);
+	STORE2(14, so);
+	STORE2(15, sp);
+	STORE2(16, sq);
+	STORE2(17, sr);
+	STORE2(18, ss);
+	STORE2(19, st);
+	STORE2(20, su);
+	STORE2(21, sv);
+	STORE2(22, sw);
+	STORE2(23, sx);
+	STORE2(24, sy);
+}
+
+//  single-state mode (both halves do the same work) for sha3_keccakp
+
+void arm_keccakp(void *s)
+{
+	arm_keccakp_x2(s, s);
+}
+
+//  pairs of consecutive states for sha3_keccakp_x
+
+void arm_keccakp_x(void *s, size_t n)
+{
+	uint64_t *v = (uint64_t *) s;
+
+	for (; n >= 2; n -= 2, v += 50)
+		arm_keccakp_x2(v, v + 25);
+	if (n > 0)
+		arm_keccakp_x2(v, v);
+}
+
+#endif
@@ -36,25 +36,25 @@ void rv32_keccakp_join(uint32_t v[50])
 	}
 }
 
+//  round constants (interleaved)
+
+static const uint32_t rv32_keccakp_rc[48] = {
+	0x00000001, 0x00000000, 0x00000000, 0x00000089, 0x00000000,
+	0x8000008B, 0x00000000, 0x80008080, 0x00000001, 0x0000008B,
+	0x00000001, 0x00008000, 0x00000001, 0x80008088, 0x00000001,
+	0x80000082, 0x00000000, 0x0000000B, 0x00000000, 0x0000000A,
+	0x00000001, 0x00008082, 0x00000000, 0x00008003, 0x00000001,
+	0x0000808B, 0x00000001, 0x8000000B, 0x00000001, 0x8000008A,
+	0x00000001, 0x80000081, 0x00000000, 0x80000081, 0x00000000,
+	0x80000008, 0x00000000, 0x00000083, 0x00000000, 0x80008003,
+	0x00000001, 0x80008088, 0x00000000, 0x80000088, 0x00000001,
+	0x00008000, 0x00000000, 0x80008082
+};
+
 //  Keccak-p[1600,24](S)
 
 void rv32_keccakp(void *s)
 {
-	//  round constants (interleaved)
-
-	const uint32_t rc[48] = {
-		0x00000001, 0x00000000, 0x00000000, 0x00000089, 0x00000000,
-		0x8000008B, 0x00000000, 0x80008080, 0x00000001, 0x0000008B,
-		0x00000001, 0x00008000, 0x00000001, 0x80008088, 0x00000001,
-		0x80000082, 0x00000000, 0x0000000B, 0x00000000, 0x0000000A,
-		0x00000001, 0x00008082, 0x00000000, 0x00008003, 0x00000001,
-		0x0000808B, 0x00000001, 0x8000000B, 0x00000001, 0x8000008A,
-		0x00000001, 0x80000081, 0x00000000, 0x80000081, 0x00000000,
-		0x80000008, 0x00000000, 0x00000083, 0x00000000, 0x80008003,
-		0x00000001, 0x80008088, 0x00000000, 0x80000088, 0x00000001,
-		0x00008000, 0x00000000, 0x80008082
-	};
-
 	uint32_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
 	uint32_t u0, u1, u2, u3;
 	const uint32_t *q;
@@ -81,7 +81,7 @@ void rv32_keccakp(void *s)
 
 	//  24 rounds
 
-	for (q = rc; q != &rc[48]; q += 2) {
+	for (q = rv32_keccakp_rc; q != &rv32_keccakp_rc[48]; q += 2) {
 
 		//  Theta
 
@@ -262,3 +262,197 @@ void rv32_keccakp(void *s)
 
 	rv32_keccakp_join(v);
 }
+
+//  === Plane-order version ===
+
+//  Loads and stores of rv32_keccakp_pl() are counted in emulation builds
+
+unsigned long rv32_keccakp_pl_lw = 0, rv32_keccakp_pl_sw = 0;
+
+#ifdef __riscv
+#define KLW(p, i)		((p)[i])
+#define KSW(p, i, x)	{ (p)[i] = (x); }
+#else
+#define KLW(p, i)		(rv32_keccakp_pl_lw++, (p)[i])
+#define KSW(p, i, x)	{ rv32_keccakp_pl_sw++; (p)[i] = (x); }
+#endif
+
+//  Theta, Rho, Pi: half-lane "b" from word "i" of the source state
+
+#define KRHO(b, i, d, r) {			\
+	b = rv32b_ror(KLW(ap, i) ^ d, r); }
+
+//  Chi (and Iota) for the first plane; these set the parities p0..p4
+
+#define KCHI0(p0, p1, p2, p3, p4, i, rc) {		\
+	p0 = b0 ^ rv32b_andn(b2, b1) ^ rc;			\
+	KSW(bp, i, p0);								\
+	p1 = b1 ^ rv32b_andn(b3, b2);				\
+	KSW(bp, i + 2, p1);							\
+	p2 = b2 ^ rv32b_andn(b4, b3);				\
+	KSW(bp, i + 4, p2);							\
+	p3 = b3 ^ rv32b_andn(b0, b4);				\
+	KSW(bp, i + 6, p3);							\
+	p4 = b4 ^ rv32b_andn(b1, b0);				\
+	KSW(bp, i + 8, p4);							}
+
+//  Chi for the other planes, accumulating parities p0..p4
+
+#define KCHI(p0, p1, p2, p3, p4, i) {			\
+	t = b0 ^ rv32b_andn(b2, b1);				\
+	KSW(bp, i, t);								\
+	p0 = p0 ^ t;								\
+	t = b1 ^ rv32b_andn(b3, b2);				\
+	KSW(bp, i + 2, t);							\
+	p1 = p1 ^ t;								\
+	t = b2 ^ rv32b_andn(b4, b3);				\
+	KSW(bp, i + 4, t);							\
+	p2 = p2 ^ t;								\
+	t = b3 ^ rv32b_andn(b0, b4);				\
+	KSW(bp, i + 6, t);							\
+	p3 = p3 ^ t;								\
+	t = b4 ^ rv32b_andn(b1, b0);				\
+	KSW(bp, i + 8, t);							\
+	p4 = p4 ^ t;								}
+
+//  Keccak-p[1600,24](S), plane by plane between two buffers. Each round
+//  reads every half-lane once from "ap" and writes it once to "bp" after
+//  Theta, Rho, Pi, Chi, and Iota; the column parities of the next round
+//  are accumulated on the way out. Ten D words and five parities live in
+//  registers; five even-half parities are spilled between the passes.
+//  Per round: 57 loads (50 state, 5 parity, 2 rc), 55 stores.
+
+void rv32_keccakp_pl(void *s)
+{
+	uint32_t b0, b1, b2, b3, b4, t;
+	uint32_t p0e, p1e, p2e, p3e, p4e, p0o, p1o, p2o, p3o, p4o;
+	uint32_t d0e, d1e, d2e, d3e, d4e, d0o, d1o, d2o, d3o, d4o;
+	uint32_t pe[5], tmp[50];
+	const uint32_t *q, *ap;
+	uint32_t *bp;
+	uint32_t *v = (uint32_t *) s;
+	int i;
+
+	rv32_keccakp_split(v);
+
+	//  initial column parities
+
+	for (i = 0; i < 5; i++)
+		pe[i] = v[2 * i] ^ v[2 * i + 10] ^ v[2 * i + 20] ^
+			v[2 * i + 30] ^ v[2 * i + 40];
+	p0o = v[1] ^ v[11] ^ v[21] ^ v[31] ^ v[41];
+	p1o = v[3] ^ v[13] ^ v[23] ^ v[33] ^ v[43];
+	p2o = v[5] ^ v[15] ^ v[25] ^ v[35] ^ v[45];
+	p3o = v[7] ^ v[17] ^ v[27] ^ v[37] ^ v[47];
+	p4o = v[9] ^ v[19] ^ v[29] ^ v[39] ^ v[49];
+
+	ap = v;
+	bp = tmp;
+
+	for (q = rv32_keccakp_rc; q != &rv32_keccakp_rc[48]; q += 2) {
+
+		//  Theta: D[x] = C[x - 1] ^ (C[x + 1] <<< 1)
+
+		p0e = KLW(pe, 0);
+		p1e = KLW(pe, 1);
+		p2e = KLW(pe, 2);
+		p3e = KLW(pe, 3);
+		p4e = KLW(pe, 4);
+
+		d0e = p4e ^ rv32b_ror(p1o, 31);
+		d0o = p4o ^ p1e;
+		d1e = p0e ^ rv32b_ror(p2o, 31);
+		d1o = p0o ^ p2e;
+		d2e = p1e ^ rv32b_ror(p3o, 31);
+		d2o = p1o ^ p3e;
+		d3e = p2e ^ rv32b_ror(p4o, 31);
+		d3o = p2o ^ p4e;
+		d4e = p3e ^ rv32b_ror(p0o, 31);
+		d4o = p3o ^ p0e;
+
+		//  even halves
+		KRHO(b0, 0, d0e, 0);
+		KRHO(b1, 12, d1e, 10);
+		KRHO(b2, 25, d2o, 10);
+		KRHO(b3, 37, d3o, 21);
+		KRHO(b4, 48, d4e, 25);
+		KCHI0(p0e, p1e, p2e, p3e, p4e, 0, KLW(q, 0));
+
+		KRHO(b0, 6, d3e, 18);
+		KRHO(b1, 18, d4e, 22);
+		KRHO(b2, 21, d0o, 30);
+		KRHO(b3, 33, d1o, 9);
+		KRHO(b4, 45, d2o, 1);
+		KCHI(p0e, p1e, p2e, p3e, p4e, 10);
+
+		KRHO(b0, 3, d1o, 31);
+		KRHO(b1, 14, d2e, 29);
+		KRHO(b2, 27, d3o, 19);
+		KRHO(b3, 38, d4e, 28);
+		KRHO(b4, 40, d0e, 23);
+		KCHI(p0e, p1e, p2e, p3e, p4e, 20);
+
+		KRHO(b0, 9, d4o, 18);
+		KRHO(b1, 10, d0e, 14);
+		KRHO(b2, 22, d1e, 27);
+		KRHO(b3, 35, d2o, 24);
+		KRHO(b4, 46, d3e, 4);
+		KCHI(p0e, p1e, p2e, p3e, p4e, 30);
+
+		KRHO(b0, 4, d2e, 1);
+		KRHO(b1, 17, d3o, 4);
+		KRHO(b2, 29, d4o, 12);
+		KRHO(b3, 31, d0o, 11);
+		KRHO(b4, 42, d1e, 31);
+		KCHI(p0e, p1e, p2e, p3e, p4e, 40);
+
+		KSW(pe, 0, p0e);					//  spill even parities
+		KSW(pe, 1, p1e);
+		KSW(pe, 2, p2e);
+		KSW(pe, 3, p3e);
+		KSW(pe, 4, p4e);
+
+		//  odd halves
+		KRHO(b0, 1, d0o, 0);
+		KRHO(b1, 13, d1o, 10);
+		KRHO(b2, 24, d2e, 11);
+		KRHO(b3, 36, d3e, 22);
+		KRHO(b4, 49, d4o, 25);
+		KCHI0(p0o, p1o, p2o, p3o, p4o, 1, KLW(q, 1));
+
+		KRHO(b0, 7, d3o, 18);
+		KRHO(b1, 19, d4o, 22);
+		KRHO(b2, 20, d0e, 31);
+		KRHO(b3, 32, d1e, 10);
+		KRHO(b4, 44, d2e, 2);
+		KCHI(p0o, p1o, p2o, p3o, p4o, 11);
+
+		KRHO(b0, 2, d1e, 0);
+		KRHO(b1, 15, d2o, 29);
+		KRHO(b2, 26, d3e, 20);
+		KRHO(b3, 39, d4o, 28);
+		KRHO(b4, 41, d0o, 23);
+		KCHI(p0o, p1o, p2o, p3o, p4o, 21);
+
+		KRHO(b0, 8, d4e, 19);
+		KRHO(b1, 11, d0o, 14);
+		KRHO(b2, 23, d1o, 27);
+		KRHO(b3, 34, d2e, 25);
+		KRHO(b4, 47, d3o, 4);
+		KCHI(p0o, p1o, p2o, p3o, p4o, 31);
+
+		KRHO(b0, 5, d2o, 1);
+		KRHO(b1, 16, d3e, 5);
+		KRHO(b2, 28, d4e, 13);
+		KRHO(b3, 30, d0e, 12);
+		KRHO(b4, 43, d1o, 31);
+		KCHI(p0o, p1o, p2o, p3o, p4o, 41);
+
+		//  swap buffers (24 rounds end in v)
+
+		bp = (uint32_t *) ap;
+		ap = bp == v ? tmp : v;
+	}
+
+	rv32_keccakp_join(v);
+}
@@ -0,0 +1,234 @@
+//  sha3_rvv_keccakp.c
+//  2020-03-05  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  FIPS 202 Keccak permutation for the RISC-V Vector Extension (RVV 1.0).
+//  Each vector register holds the same lane of VLEN/64 independent states,
+//  so 25 registers hold the states and the remaining 7 are temporaries.
+//  The structure is exactly that of sha3_rv64_keccakp.c.
+
+#ifdef __riscv_vector
+
+#include <stddef.h>
+#include <riscv_vector.h>
+
+#include "sha3_wrap.h"
+
+//  Zvbb has rotate and and-not; otherwise they take 3 and 2 instructions
+
+#define VXOR(a, b)	__riscv_vxor_vv_u64m1(a, b, vl)
+#ifdef __riscv_zvbb
+#define VROR(a, n)	__riscv_vror_vx_u64m1(a, n, vl)
+#define VANDN(a, b) __riscv_vandn_vv_u64m1(a, b, vl)
+#else
+#define VROR(a, n)	__riscv_vor_vv_u64m1(__riscv_vsrl_vx_u64m1(a, n, vl), \
+					__riscv_vsll_vx_u64m1(a, 64 - (n), vl), vl)
+#define VANDN(a, b) __riscv_vand_vv_u64m1(a, __riscv_vnot_v_u64m1(b, vl), vl)
+#endif
+
+//  strided load and store of lane "i" across states 200 bytes apart
+
+#define VLOAD(i)	__riscv_vlse64_v_u64m1(&vs[i], 200, vl)
+#define VSTORE(i, x) __riscv_vsse64_v_u64m1(&vs[i], 200, x, vl)
+
+//  Keccak-p[1600,24](S) for "n" consecutive states
+
+void rvv_keccakp_x(void *s, size_t n)
+{
+	//  round constants
+	const uint64_t rc[24] = {
+		0x0000000000000001LL, 0x0000000000008082LL, 0x800000000000808ALL,
+		0x8000000080008000LL, 0x000000000000808BLL, 0x0000000080000001LL,
+		0x8000000080008081LL, 0x8000000000008009LL, 0x000000000000008ALL,
+		0x0000000000000088LL, 0x0000000080008009LL, 0x000000008000000ALL,
+		0x000000008000808BLL, 0x800000000000008BLL, 0x8000000000008089LL,
+		0x8000000000008003LL, 0x8000000000008002LL, 0x8000000000000080LL,
+		0x000000000000800ALL, 0x800000008000000ALL, 0x8000000080008081LL,
+		0x8000000000008080LL, 0x0000000080000001LL, 0x8000000080008008LL
+	};
+
+	int i;
+	size_t vl;
+	vuint64m1_t t, u, v, w;
+	vuint64m1_t sa, sb, sc, sd, se, sf, sg, sh, si, sj, sk, sl, sm,
+		sn, so, sp, sq, sr, ss, st, su, sv, sw, sx, sy;
+
+	uint64_t *vs = (uint64_t *) s;
+
+	for (; n > 0; n -= vl, vs += 25 * vl) {
+
+		vl = __riscv_vsetvl_e64m1(n);
+
+		//  load lanes of vl states
+
+		sa = VLOAD(0);
+		sb = VLOAD(1);
+		sc = VLOAD(2);
+		sd = VLOAD(3);
+		se = VLOAD(4);
+		sf = VLOAD(5);
+		sg = VLOAD(6);
+		sh = VLOAD(7);
+		si = VLOAD(8);
+		sj = VLOAD(9);
+		sk = VLOAD(10);
+		sl = VLOAD(11);
+		sm = VLOAD(12);
+		sn = VLOAD(13);
+		so = VLOAD(14);
+		sp = VLOAD(15);
+		sq = VLOAD(16);
+		sr = VLOAD(17);
+		ss = VLOAD(18);
+		st = VLOAD(19);
+		su = VLOAD(20);
+		sv = VLOAD(21);
+		sw = VLOAD(22);
+		sx = VLOAD(23);
+		sy = VLOAD(24);
+
+		for (i = 0; i < 24; i++) {
+
+			//  Theta
+
+			u = VXOR(VXOR(VXOR(VXOR(sa, sf), sk), sp), su);
+			v = VXOR(VXOR(VXOR(VXOR(sb, sg), sl), sq), sv);
+			w = VXOR(VXOR(VXOR(VXOR(se, sj), so), st), sy);
+			t = VXOR(w, VROR(v, 63));
+			sa = VXOR(sa, t);
+			sf = VXOR(sf, t);
+			sk = VXOR(sk, t);
+			sp = VXOR(sp, t);
+			su = VXOR(su, t);
+
+			t = VXOR(VXOR(VXOR(VXOR(sd, si), sn), ss), sx);
+			v = VXOR(v, VROR(t, 63));
+			t = VXOR(t, VROR(u, 63));
+			se = VXOR(se, t);
+			sj = VXOR(sj, t);
+			so = VXOR(so, t);
+			st = VXOR(st, t);
+			sy = VXOR(sy, t);
+
+			t = VXOR(VXOR(VXOR(VXOR(sc, sh), sm), sr), sw);
+			u = VXOR(u, VROR(t, 63));
+			t = VXOR(t, VROR(w, 63));
+			sc = VXOR(sc, v);
+			sh = VXOR(sh, v);
+			sm = VXOR(sm, v);
+			sr = VXOR(sr, v);
+			sw = VXOR(sw, v);
+
+			sb = VXOR(sb, u);
+			sg = VXOR(sg, u);
+			sl = VXOR(sl, u);
+			sq = VXOR(sq, u);
+			sv = VXOR(sv, u);
+
+			sd = VXOR(sd, t);
+			si = VXOR(si, t);
+			sn = VXOR(sn, t);
+			ss = VXOR(ss, t);
+			sx = VXOR(sx, t);
+
+			//  Rho Pi
+
+			t = VROR(sb, 63);
+			sb = VROR(sg, 20);
+			sg = VROR(sj, 44);
+			sj = VROR(sw, 3);
+			sw = VROR(so, 25);
+			so = VROR(su, 46);
+			su = VROR(sc, 2);
+			sc = VROR(sm, 21);
+			sm = VROR(sn, 39);
+			sn = VROR(st, 56);
+			st = VROR(sx, 8);
+			sx = VROR(sp, 23);
+			sp = VROR(se, 37);
+			se = VROR(sy, 50);
+			sy = VROR(sv, 62);
+			sv = VROR(si, 9);
+			si = VROR(sq, 19);
+			sq = VROR(sf, 28);
+			sf = VROR(sd, 36);
+			sd = VROR(ss, 43);
+			ss = VROR(sr, 49);
+			sr = VROR(sl, 54);
+			sl = VROR(sh, 58);
+			sh = VROR(sk, 61);
+			sk = t;
+
+			//  Chi
+
+			t = VANDN(se, sd);
+			se = VXOR(se, VANDN(sb, sa));
+			sb = VXOR(sb, VANDN(sd, sc));
+			sd = VXOR(sd, VANDN(sa, se));
+			sa = VXOR(sa, VANDN(sc, sb));
+			sc = VXOR(sc, t);
+
+			t = VANDN(sj, si);
+			sj = VXOR(sj, VANDN(sg, sf));
+			sg = VXOR(sg, VANDN(si, sh));
+			si = VXOR(si, VANDN(sf, sj));
+			sf = VXOR(sf, VANDN(sh, sg));
+			sh = VXOR(sh, t);
+
+			t = VANDN(so, sn);
+			so = VXOR(so, VANDN(sl, sk));
+			sl = VXOR(sl, VANDN(sn, sm));
+			sn = VXOR(sn, VANDN(sk, so));
+			sk = VXOR(sk, VANDN(sm, sl));
+			sm = VXOR(sm, t);
+
+			t = VANDN(st, ss);
+			st = VXOR(st, VANDN(sq, sp));
+			sq = VXOR(sq, VANDN(ss, sr));
+			ss = VXOR(ss, VANDN(sp, st));
+			sp = VXOR(sp, VANDN(sr, sq));
+			sr = VXOR(sr, t);
+
+			t = VANDN(sy, sx);
+			sy = VXOR(sy, VANDN(sv, su));
+			sv = VXOR(sv, VANDN(sx, sw));
+			sx = VXOR(sx, VANDN(su, sy));
+			su = VXOR(su, VANDN(sw, sv));
+			sw = VXOR(sw, t);
+
+			//  Iota
+
+			sa = __riscv_vxor_vx_u64m1(sa, rc[i], vl);
+		}
+
+		//  store lanes
+
+		VSTORE(0, sa);
+		VSTORE(1, sb);
+		VSTORE(2, sc);
+		VSTORE(3, sd);
+		VSTORE(4, se);
+		VSTORE(5, sf);
+		VSTORE(6, sg);
+		VSTORE(7, sh);
+		VSTORE(8, si);
+		VSTORE(9, sj);
+		VSTORE(10, sk);
+		VSTORE(11, sl);
+		VSTORE(12, sm);
+		VSTORE(13, sn);
+		VSTORE(14, so);
+		VSTORE(15, sp);
+		VSTORE(16, sq);
+		VSTORE(17, sr);
+		VSTORE(18, ss);
+		VSTORE(19, st);
+		VSTORE(20, su);
+		VSTORE(21, sv);
+		VSTORE(22, sw);
+		VSTORE(23, sx);
+		VSTORE(24, sy);
+	}
+}
+
+#endif
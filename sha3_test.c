@@ -4,6 +4,8 @@
 
 //  Unit tests for FIPS 202 SHA-3.
 
+#include <time.h>
+
 #include "test_hex.h"
 #include "sha3_wrap.h"
 
@@ -147,3 +149,184 @@ int test_shake()
 
 	return fail;
 }
+
+//  Rate-specialized functions against the generic ones, with split inputs.
+
+int test_sha3_rate()
+{
+	const size_t split[] = { 0, 1, 71, 72, 136, 200, 300, 499, 500 };
+	size_t i, j;
+	uint8_t in[500], md1[600], md2[600];
+	sha3_ctx_t c1, c2;
+	int fail = 0;
+
+	for (i = 0; i < sizeof(in); i++)
+		in[i] = (uint8_t) (i * 0x3B + 7);
+
+	for (i = 0; i < sizeof(split) / sizeof(split[0]); i++) {
+
+		j = split[i];
+
+		sha3(md1, 28, in, sizeof(in));
+		sha3_224_init(&c2);
+		sha3_224_update(&c2, in, j);
+		sha3_224_update(&c2, in + j, sizeof(in) - j);
+		sha3_224_final(md2, &c2);
+		fail += memcmp(md1, md2, 28) != 0;
+
+		sha3(md1, 32, in, sizeof(in));
+		sha3_256_init(&c2);
+		sha3_256_update(&c2, in, j);
+		sha3_256_update(&c2, in + j, sizeof(in) - j);
+		sha3_256_final(md2, &c2);
+		fail += memcmp(md1, md2, 32) != 0;
+
+		sha3(md1, 48, in, sizeof(in));
+		sha3_384_init(&c2);
+		sha3_384_update(&c2, in, j);
+		sha3_384_update(&c2, in + j, sizeof(in) - j);
+		sha3_384_final(md2, &c2);
+		fail += memcmp(md1, md2, 48) != 0;
+
+		sha3(md1, 64, in, sizeof(in));
+		sha3_512_init(&c2);
+		sha3_512_update(&c2, in, j);
+		sha3_512_update(&c2, in + j, sizeof(in) - j);
+		sha3_512_final(md2, &c2);
+		fail += memcmp(md1, md2, 64) != 0;
+
+		//  squeeze in two pieces, too
+
+		shake128_init(&c1);
+		shake_update(&c1, in, sizeof(in));
+		shake_xof(&c1);
+		shake_out(md1, sizeof(md1), &c1);
+		shake128_init(&c2);
+		shake128_update(&c2, in, j);
+		shake128_update(&c2, in + j, sizeof(in) - j);
+		shake_xof(&c2);
+		shake128_squeeze(md2, j, &c2);
+		shake128_squeeze(md2 + j, sizeof(md2) - j, &c2);
+		fail += memcmp(md1, md2, sizeof(md1)) != 0;
+
+		shake256_init(&c1);
+		shake_update(&c1, in, sizeof(in));
+		shake_xof(&c1);
+		shake_out(md1, sizeof(md1), &c1);
+		shake256_init(&c2);
+		shake256_update(&c2, in, j);
+		shake256_update(&c2, in + j, sizeof(in) - j);
+		shake_xof(&c2);
+		shake256_squeeze(md2, j, &c2);
+		shake256_squeeze(md2 + j, sizeof(md2) - j, &c2);
+		fail += memcmp(md1, md2, sizeof(md1)) != 0;
+	}
+
+	//  one known-answer test
+
+	sha3_256_init(&c2);
+	sha3_256_update(&c2, "abc", 3);
+	sha3_256_final(md2, &c2);
+	fail += chkhex("SHA3-256", md2, 32,
+				   "3A985DA74FE225B2045C172D6BD390BD855F086E3E9D525B46BFE24511431532");
+
+	return chkret("SHA3 rate-specialized", 0, fail);
+}
+
+//  Multi-state permutation against sha3_keccakp; reports relative speed.
+
+int test_keccakp_x()
+{
+	const size_t n = 64;
+	size_t i;
+	uint64_t st1[64 * 25], st2[64 * 25];
+	clock_t t1, t2;
+	int fail = 0;
+
+	for (i = 0; i < n * 25; i++)
+		st1[i] = st2[i] = 0x9E3779B97F4A7C15LL * (i + 1);
+
+	t1 = clock();
+	for (i = 0; i < 100; i++)
+		sha3_keccakp_x(st1, n);
+	t1 = clock() - t1;
+
+	t2 = clock();
+	for (i = 0; i < 100; i++)
+		sha3_keccakp_seq(st2, n);
+	t2 = clock() - t2;
+
+	fail = memcmp(st1, st2, sizeof(st1)) != 0;
+	printf("[INFO] sha3_keccakp_x(): %.2f x sha3_keccakp() (%d states)\n",
+		   t1 > 0 ? ((double) t2) / ((double) t1) : 0.0, (int) n);
+
+	return chkret("KECCAK-P multi-state", 0, fail);
+}
+
+//  Multi-state SHA3 and SHAKE front end against the single-state one.
+
+int test_sha3_x()
+{
+	const size_t inlen[] = { 0, 71, 136, 168, 500 };
+	size_t i, j, k;
+	uint8_t in[19][500], md[19][400], ref[400];
+	uint8_t *mdp[19];
+	const void *inp[19];
+	sha3_ctx_t c;
+	int fail = 0;
+
+	for (i = 0; i < 19; i++) {
+		for (j = 0; j < sizeof(in[i]); j++)
+			in[i][j] = (uint8_t) (i * 0x3D + j * 0x11 + 5);
+		inp[i] = in[i];
+		mdp[i] = md[i];
+	}
+
+	for (k = 0; k < sizeof(inlen) / sizeof(inlen[0]); k++) {
+
+		for (j = 28; j <= 64; j += (j == 28 ? 4 : 16)) {
+			sha3_x(mdp, j, inp, inlen[k], 19);
+			for (i = 0; i < 19; i++) {
+				sha3(ref, j, in[i], inlen[k]);
+				fail += memcmp(md[i], ref, j) != 0;
+			}
+		}
+
+		for (j = 16; j <= 32; j += 16) {
+			shake_x(mdp, sizeof(ref), j, inp, inlen[k], 19);
+			for (i = 0; i < 19; i++) {
+				sha3_init(&c, j);
+				shake_update(&c, in[i], inlen[k]);
+				shake_xof(&c);
+				shake_out(ref, sizeof(ref), &c);
+				fail += memcmp(md[i], ref, sizeof(ref)) != 0;
+			}
+		}
+	}
+
+	return chkret("SHA3 multi-state", 0, fail);
+}
+
+//  Memory access count of rv32_keccakp_pl() per round. The counters are
+//  bumped by the same macros that do the accesses, so this pins down the
+//  source model; it says nothing about spills in compiled code.
+
+int test_keccakp_pl_count()
+{
+	int fail = 0;
+#ifndef __riscv
+	uint8_t st[200];
+
+	memset(st, 0, sizeof(st));
+	rv32_keccakp_pl_lw = 0;
+	rv32_keccakp_pl_sw = 0;
+	rv32_keccakp_pl(st);
+
+	fail += chkret("rv32_keccakp_pl() loads per round", 57,
+				   (int) (rv32_keccakp_pl_lw / 24));
+	fail += chkret("rv32_keccakp_pl() stores per round", 55,
+				   (int) (rv32_keccakp_pl_sw / 24));
+	fail += rv32_keccakp_pl_lw % 24 != 0 || rv32_keccakp_pl_sw % 24 != 0;
+#endif
+	return fail;
+}
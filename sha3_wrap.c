@@ -6,13 +6,18 @@
 //  Hash padding mode code for testing permutation implementations.
 
 #include "sha3_wrap.h"
+#include "rv_endian.h"
 
 //  These functions have not been optimized for performance -- they are
 //  here just to facilitate testing of the permutation code implementations.
 
 //  externally visible pointer to the permutation implementation
 
+#if defined(__riscv) && (__riscv_xlen == 64) && defined(__riscv_zbb)
+void (*sha3_keccakp)(void *) = rv64_keccakp_asm;
+#else
 void (*sha3_keccakp)(void *) = rv64_keccakp;
+#endif
 
 //  initialize the context for SHA3
 
@@ -102,3 +107,192 @@ void shake_out(uint8_t * out, size_t len, sha3_ctx_t * c)
 	}
 	c->pt = j;
 }
+
+//  Rate-specialized versions. The "rsiz" argument of these inline functions
+//  is always a constant so the lane loops unroll and byte-level bounds
+//  checks only remain for partial blocks.
+
+static inline void sha3_absorb_r(sha3_ctx_t * c, const uint8_t * in,
+								 size_t len, const int rsiz)
+{
+	int i, j;
+
+	j = c->pt;
+	if (j > 0) {							//  complete a partial block
+		while (len > 0 && j < rsiz) {
+			c->st.b[j++] ^= *in++;
+			len--;
+		}
+		if (j < rsiz) {
+			c->pt = j;
+			return;
+		}
+		sha3_keccakp(c->st.d);
+	}
+
+	while (len >= (size_t) rsiz) {			//  full blocks, lane by lane
+		for (i = 0; i < rsiz / 8; i++)
+			c->st.d[i] ^= get64u_le(in + 8 * i);
+		sha3_keccakp(c->st.d);
+		in += rsiz;
+		len -= rsiz;
+	}
+
+	for (j = 0; j < (int) len; j++)			//  trailing partial block
+		c->st.b[j] ^= in[j];
+	c->pt = j;
+}
+
+static inline void sha3_final_r(uint8_t * md, sha3_ctx_t * c,
+								const int rsiz, const int mdlen)
+{
+	int i;
+
+	c->st.b[c->pt] ^= 0x06;
+	c->st.b[rsiz - 1] ^= 0x80;
+	sha3_keccakp(c->st.d);
+
+	for (i = 0; i < mdlen / 8; i++)
+		put64u_le(md + 8 * i, c->st.d[i]);
+	for (i = i * 8; i < mdlen; i++)			//  SHA3-224 has a half lane
+		md[i] = c->st.b[i];
+}
+
+static inline void shake_squeeze_r(uint8_t * out, size_t len,
+								   sha3_ctx_t * c, const int rsiz)
+{
+	int i, j;
+
+	j = c->pt;
+	while (len > 0 && j < rsiz) {			//  rest of the current block
+		*out++ = c->st.b[j++];
+		len--;
+	}
+
+	while (len >= (size_t) rsiz) {			//  full blocks, lane by lane
+		sha3_keccakp(c->st.d);
+		for (i = 0; i < rsiz / 8; i++)
+			put64u_le(out + 8 * i, c->st.d[i]);
+		out += rsiz;
+		len -= rsiz;
+	}
+
+	if (len > 0) {							//  start of a new block
+		sha3_keccakp(c->st.d);
+		for (j = 0; j < (int) len; j++)
+			out[j] = c->st.b[j];
+	}
+	c->pt = j;
+}
+
+//  instantiate for each fixed rate
+
+#define SHA3_RATE_FUNCS(name, rsiz, mdlen)							\
+void name##_update(sha3_ctx_t * c, const void *data, size_t len)	\
+{ sha3_absorb_r(c, (const uint8_t *) data, len, rsiz); }			\
+void name##_final(uint8_t * md, sha3_ctx_t * c)						\
+{ sha3_final_r(md, c, rsiz, mdlen); }
+
+SHA3_RATE_FUNCS(sha3_224, 144, 28)
+SHA3_RATE_FUNCS(sha3_256, 136, 32)
+SHA3_RATE_FUNCS(sha3_384, 104, 48)
+SHA3_RATE_FUNCS(sha3_512, 72, 64)
+
+#define SHAKE_RATE_FUNCS(name, rsiz)								\
+void name##_update(sha3_ctx_t * c, const void *data, size_t len)	\
+{ sha3_absorb_r(c, (const uint8_t *) data, len, rsiz); }			\
+void name##_squeeze(uint8_t * out, size_t len, sha3_ctx_t * c)		\
+{ shake_squeeze_r(out, len, c, rsiz); }
+
+SHAKE_RATE_FUNCS(shake128, 168)
+SHAKE_RATE_FUNCS(shake256, 136)
+
+//  Multi-state interface. States are processed SHA3_X_MAX at a time.
+
+#define SHA3_X_MAX 16
+
+void (*sha3_keccakp_x)(void *, size_t) = sha3_keccakp_seq;
+
+//  default: no parallelism
+
+void sha3_keccakp_seq(void *s, size_t n)
+{
+	uint64_t *v = (uint64_t *) s;
+
+	while (n-- > 0) {
+		sha3_keccakp(v);
+		v += 25;
+	}
+}
+
+//  padding mode for equal-length inputs; "ds" is the domain separator
+
+static void sha3_sponge_x(uint8_t * out[], size_t outlen, int rsiz,
+						  uint8_t ds, const void *in[], size_t inlen,
+						  size_t n)
+{
+	size_t i, j, k, m, pos, len;
+	uint64_t st[SHA3_X_MAX * 25];
+	uint8_t *b;
+	const uint8_t *p;
+
+	for (k = 0; k < n; k += m) {
+		m = n - k < SHA3_X_MAX ? n - k : SHA3_X_MAX;
+
+		for (i = 0; i < m * 25; i++)
+			st[i] = 0;
+
+		//  absorb full blocks
+
+		for (pos = 0; pos + rsiz <= inlen; pos += rsiz) {
+			for (i = 0; i < m; i++) {
+				p = (const uint8_t *) in[k + i] + pos;
+				for (j = 0; j < (size_t) rsiz / 8; j++)
+					st[25 * i + j] ^= get64u_le(p + 8 * j);
+			}
+			sha3_keccakp_x(st, m);
+		}
+
+		//  last partial block and padding
+
+		len = inlen - pos;
+		for (i = 0; i < m; i++) {
+			b = (uint8_t *) & st[25 * i];
+			p = (const uint8_t *) in[k + i] + pos;
+			for (j = 0; j < len; j++)
+				b[j] ^= p[j];
+			b[len] ^= ds;
+			b[rsiz - 1] ^= 0x80;
+		}
+		sha3_keccakp_x(st, m);
+
+		//  squeeze
+
+		for (pos = 0; pos < outlen; pos += rsiz) {
+			if (pos > 0)
+				sha3_keccakp_x(st, m);
+			len = outlen - pos < (size_t) rsiz ? outlen - pos : rsiz;
+			for (i = 0; i < m; i++) {
+				b = (uint8_t *) & st[25 * i];
+				for (j = 0; j < len; j++)
+					out[k + i][pos + j] = b[j];
+			}
+		}
+	}
+}
+
+//  compute "n" SHA-3 hashes md[i] of "mdlen" bytes from in[i], all inlen
+
+void sha3_x(uint8_t * md[], int mdlen,
+			const void *in[], size_t inlen, size_t n)
+{
+	sha3_sponge_x(md, mdlen, 200 - 2 * mdlen, 0x06, in, inlen, n);
+}
+
+//  "n" SHAKE outputs of "outlen" bytes; mdlen = 16 or 32 as in shake*_init
+
+void shake_x(uint8_t * out[], size_t outlen, int mdlen,
+			 const void *in[], size_t inlen, size_t n)
+{
+	sha3_sponge_x(out, outlen, 200 - 2 * mdlen, 0x1F, in, inlen, n);
+}
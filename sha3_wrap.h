@@ -26,9 +26,19 @@ extern void (*sha3_keccakp)(void *);
 
 //  which is set to point to an external function, one of:
 void rv32_keccakp(void *);					//  rv32_keccakp.c
+void rv32_keccakp_pl(void *);				//  rv32_keccakp.c, plane order
 void rv64_keccakp(void *);					//  rv64_keccakp.c
+#if defined(__riscv) && (__riscv_xlen == 64) && defined(__riscv_zbb)
+void rv64_keccakp_asm(void *);				//  sha3_rv64_asm.S
+#endif
+#if defined(__aarch64__) && defined(__ARM_FEATURE_SHA3)
+void arm_keccakp(void *);					//  sha3_arm_keccakp.c
+#endif
 //void ref_keccakp(void *);                 //  ref_keccakp.c ("reference")
 
+//  loads and stores of rv32_keccakp_pl() in the round loop (emulation)
+extern unsigned long rv32_keccakp_pl_lw, rv32_keccakp_pl_sw;
+
 //  incremental interfece
 void sha3_init(sha3_ctx_t * c, int mdlen);	//  mdlen = hash output in bytes
 void sha3_update(sha3_ctx_t * c, const void *data, size_t len);
@@ -45,4 +55,53 @@ void shake_xof(sha3_ctx_t * c);
 //  squeeze output (can call repeat)
 void shake_out(uint8_t * out, size_t len, sha3_ctx_t * c);
 
+//  === Rate-specialized instantiations ===
+//  Same context and semantics as above, but the rate is a compile-time
+//  constant. Initialize with the matching init macro (or sha3_init()).
+
+#define sha3_224_init(c) sha3_init(c, 28)
+#define sha3_256_init(c) sha3_init(c, 32)
+#define sha3_384_init(c) sha3_init(c, 48)
+#define sha3_512_init(c) sha3_init(c, 64)
+
+void sha3_224_update(sha3_ctx_t * c, const void *data, size_t len);
+void sha3_256_update(sha3_ctx_t * c, const void *data, size_t len);
+void sha3_384_update(sha3_ctx_t * c, const void *data, size_t len);
+void sha3_512_update(sha3_ctx_t * c, const void *data, size_t len);
+
+void sha3_224_final(uint8_t * md, sha3_ctx_t * c);
+void sha3_256_final(uint8_t * md, sha3_ctx_t * c);
+void sha3_384_final(uint8_t * md, sha3_ctx_t * c);
+void sha3_512_final(uint8_t * md, sha3_ctx_t * c);
+
+void shake128_update(sha3_ctx_t * c, const void *data, size_t len);
+void shake256_update(sha3_ctx_t * c, const void *data, size_t len);
+
+void shake128_squeeze(uint8_t * out, size_t len, sha3_ctx_t * c);
+void shake256_squeeze(uint8_t * out, size_t len, sha3_ctx_t * c);
+
+
+//  === Multi-state interface ===
+
+//  function pointer to a permutation of "n" consecutive 200-byte states
+extern void (*sha3_keccakp_x)(void *, size_t);
+
+//  which is set to one of:
+void sha3_keccakp_seq(void *, size_t);		//  calls sha3_keccakp n times
+#ifdef __riscv_vector
+void rvv_keccakp_x(void *, size_t);			//  sha3_rvv_keccakp.c
+#endif
+#if defined(__aarch64__) && defined(__ARM_FEATURE_SHA3)
+void arm_keccakp_x(void *, size_t);			//  sha3_arm_keccakp.c
+void arm_keccakp_x2(void *, void *);		//  two states at once
+#endif
+
+//  compute "n" SHA-3 hashes md[i] of "mdlen" bytes from in[i], all inlen
+void sha3_x(uint8_t * md[], int mdlen,
+			const void *in[], size_t inlen, size_t n);
+
+//  "n" SHAKE outputs of "outlen" bytes; mdlen = 16 or 32 as in shake*_init
+void shake_x(uint8_t * out[], size_t outlen, int mdlen,
+			 const void *in[], size_t inlen, size_t n);
+
 #endif
@@ -0,0 +1,331 @@
+//  slh_hash.c
+//  2020-03-15  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  SLH-DSA tweakable hashes. SHA2: the PK.seed block "PK.seed | 0 .. 0" is
+//  the same in every call, so it is compressed once in slh_hash_init() and
+//  each call continues from that midstate with the 22-byte compressed
+//  address. F and PRF (and H for n = 16) are then a single SHA2-256 block;
+//  H for n = 24, 32 is a single SHA2-512 block. SHAKE256: "PK.seed | ADRS |
+//  M" of F, H, and PRF is at most 128 bytes, so it goes straight into the
+//  rate of the Keccak state with the padding, and one permutation follows.
+
+#include <string.h>
+#include "slh_hash.h"
+#include "sha2_wrap.h"
+#include "sha3_wrap.h"
+#include "rv_endian.h"
+
+#define SLH_X_MAX 16						//  lanes per group
+
+static const uint8_t slh_zero[128] = { 0 };
+
+//  set up; compress the seed blocks
+
+int slh_hash_init(slh_hash_t * sh, int alg, int n, const uint8_t * seed)
+{
+	int i;
+	uint8_t b[128];
+
+	if ((alg != SLH_SHA2 && alg != SLH_SHAKE) ||
+		(n != 16 && n != 24 && n != 32))
+		return -1;
+
+	sh->alg = alg;
+	sh->n = n;
+	memcpy(sh->seed, seed, n);
+
+	if (alg == SLH_SHA2) {
+		memset(b, 0x00, sizeof(b));
+		memcpy(b, seed, n);
+		for (i = 0; i < 8; i++) {
+			sh->s256[i] = sha2_256_h0[i];
+			sh->s512[i] = sha2_512_h0[i];
+		}
+		sha256_blocks(sh->s256, b, 1);
+		sha512_blocks(sh->s512, b, 1);
+	}
+
+	return 0;
+}
+
+//  === SHA2 ===
+
+//  ADRSc = ADRS[3] | ADRS[8:16] | ADRS[19] | ADRS[20:32], 22 bytes
+
+static void slh_adrsc(uint8_t * c, const uint8_t * adrs)
+{
+	c[0] = adrs[3];
+	memcpy(c + 1, adrs + 8, 8);
+	c[9] = adrs[19];
+	memcpy(c + 10, adrs + 20, 12);
+}
+
+//  the last block "ADRSc | m | padding" after the 64-byte seed block; "m"
+//  is at most 55 - 22 = 33 bytes
+
+static void slh_blk256(uint8_t * b, const uint8_t * adrs,
+					   const uint8_t * m, size_t mlen)
+{
+	slh_adrsc(b, adrs);
+	memcpy(b + 22, m, mlen);
+	b[22 + mlen] = 0x80;
+	memset(b + 23 + mlen, 0x00, 56 - 23 - mlen);
+	put64u_be(b + 56, (64 + 22 + mlen) << 3);
+}
+
+//  .. and after the 128-byte seed block; at most 111 - 22 = 89 bytes
+
+static void slh_blk512(uint8_t * b, const uint8_t * adrs,
+					   const uint8_t * m, size_t mlen)
+{
+	slh_adrsc(b, adrs);
+	memcpy(b + 22, m, mlen);
+	b[22 + mlen] = 0x80;
+	memset(b + 23 + mlen, 0x00, 120 - 23 - mlen);
+	put64u_be(b + 120, (128 + 22 + mlen) << 3);
+}
+
+//  SHA2-256 or SHA2-512 from the seed midstate over "ADRSc | m", truncated
+
+static void slh_sha256(uint8_t * md, const slh_hash_t * sh,
+					   const uint8_t * adrs, const uint8_t * m, size_t mlen)
+{
+	int i;
+	uint8_t b[64], t[32];
+	sha2_256_ctx_t c;
+
+	if (mlen <= 33) {						//  single block
+		slh_blk256(b, adrs, m, mlen);
+		for (i = 0; i < 8; i++)
+			c.s[i] = sh->s256[i];
+		sha256_blocks(c.s, b, 1);
+		for (i = 0; i < 8; i++)
+			put32u_be(t + 4 * i, c.s[i]);
+	} else {
+		for (i = 0; i < 8; i++)
+			c.s[i] = sh->s256[i];
+		c.len = 64;
+		c.mdlen = 32;
+		slh_adrsc(b, adrs);
+		sha2_256_update(&c, b, 22);
+		sha2_256_update(&c, m, mlen);
+		sha2_256_final(t, &c);
+	}
+	memcpy(md, t, sh->n);
+}
+
+static void slh_sha512(uint8_t * md, const slh_hash_t * sh,
+					   const uint8_t * adrs, const uint8_t * m, size_t mlen)
+{
+	int i;
+	uint8_t b[128], t[64];
+	sha2_512_ctx_t c;
+
+	if (mlen <= 89) {						//  single block
+		slh_blk512(b, adrs, m, mlen);
+		for (i = 0; i < 8; i++)
+			c.s[i] = sh->s512[i];
+		sha512_blocks(c.s, b, 1);
+		for (i = 0; i < 8; i++)
+			put64u_be(t + 8 * i, c.s[i]);
+	} else {
+		for (i = 0; i < 8; i++)
+			c.s[i] = sh->s512[i];
+		c.len = 128;
+		c.mdlen = 64;
+		slh_adrsc(b, adrs);
+		sha2_512_update(&c, b, 22);
+		sha2_512_update(&c, m, mlen);
+		sha2_512_final(t, &c);
+	}
+	memcpy(md, t, sh->n);
+}
+
+//  === SHAKE256 ===
+
+//  SHAKE256(PK.seed | ADRS | m) of "n" bytes
+
+static void slh_shake(uint8_t * md, const slh_hash_t * sh,
+					  const uint8_t * adrs, const uint8_t * m, size_t mlen)
+{
+	int n = sh->n;
+	sha3_ctx_t c;
+
+	if (n + SLH_ADRS + mlen < 136) {		//  single block, direct
+		memset(c.st.b, 0x00, 200);
+		memcpy(c.st.b, sh->seed, n);
+		memcpy(c.st.b + n, adrs, SLH_ADRS);
+		memcpy(c.st.b + n + SLH_ADRS, m, mlen);
+		c.st.b[n + SLH_ADRS + mlen] = 0x1F;
+		c.st.b[135] ^= 0x80;
+		sha3_keccakp(c.st.d);
+		memcpy(md, c.st.b, n);
+	} else {
+		shake256_init(&c);
+		shake256_update(&c, sh->seed, n);
+		shake256_update(&c, adrs, SLH_ADRS);
+		shake256_update(&c, m, mlen);
+		shake_xof(&c);
+		shake_out(md, n, &c);
+	}
+}
+
+//  === Tweakable hash functions ===
+
+void slh_f(uint8_t * md, const slh_hash_t * sh,
+		   const uint8_t * adrs, const uint8_t * m)
+{
+	if (sh->alg == SLH_SHA2)
+		slh_sha256(md, sh, adrs, m, sh->n);
+	else
+		slh_shake(md, sh, adrs, m, sh->n);
+}
+
+void slh_prf(uint8_t * md, const slh_hash_t * sh,
+			 const uint8_t * adrs, const uint8_t * sk)
+{
+	slh_f(md, sh, adrs, sk);
+}
+
+//  H and T_l use SHA2-512 for n = 24, 32
+
+void slh_t(uint8_t * md, const slh_hash_t * sh,
+		   const uint8_t * adrs, const uint8_t * m, size_t l)
+{
+	if (sh->alg == SLH_SHAKE)
+		slh_shake(md, sh, adrs, m, l * sh->n);
+	else if (sh->n == 16)
+		slh_sha256(md, sh, adrs, m, l * sh->n);
+	else
+		slh_sha512(md, sh, adrs, m, l * sh->n);
+}
+
+void slh_h(uint8_t * md, const slh_hash_t * sh,
+		   const uint8_t * adrs, const uint8_t * m)
+{
+	slh_t(md, sh, adrs, m, 2);
+}
+
+//  === Lanes ===
+
+//  SHA2: single blocks through the lane kernels from the seed midstate
+
+static void slh_sha256_x(uint8_t * md[], const slh_hash_t * sh,
+						 const uint8_t * const adrs[],
+						 const uint8_t * const m[], size_t mlen, size_t cnt)
+{
+	int i, j, lanes;
+	size_t k;
+	uint32_t mask, s[8 * SHA2_MB_MAX];
+	uint8_t b[SHA2_MB_MAX][64], t[32];
+	const uint8_t *bp[SHA2_MB_MAX];
+
+	lanes = sha256_mb_lanes;
+
+	for (k = 0; k < cnt; k += lanes) {
+		mask = 0;
+		for (j = 0; j < lanes; j++) {
+			if (k + j < cnt) {
+				slh_blk256(b[j], adrs[k + j], m[k + j], mlen);
+				bp[j] = b[j];
+				mask |= 1u << j;
+			} else {
+				bp[j] = slh_zero;			//  idle lane
+			}
+			for (i = 0; i < 8; i++)
+				s[lanes * i + j] = sh->s256[i];
+		}
+		sha256_mb(s, bp, mask);
+		for (j = 0; j < lanes && k + j < cnt; j++) {
+			for (i = 0; i < 8; i++)
+				put32u_be(t + 4 * i, s[lanes * i + j]);
+			memcpy(md[k + j], t, sh->n);
+		}
+	}
+}
+
+static void slh_sha512_x(uint8_t * md[], const slh_hash_t * sh,
+						 const uint8_t * const adrs[],
+						 const uint8_t * const m[], size_t mlen, size_t cnt)
+{
+	int i, j, lanes;
+	size_t k;
+	uint32_t mask;
+	uint64_t s[8 * SHA2_MB_MAX];
+	uint8_t b[SHA2_MB_MAX][128], t[64];
+	const uint8_t *bp[SHA2_MB_MAX];
+
+	lanes = sha512_mb_lanes;
+
+	for (k = 0; k < cnt; k += lanes) {
+		mask = 0;
+		for (j = 0; j < lanes; j++) {
+			if (k + j < cnt) {
+				slh_blk512(b[j], adrs[k + j], m[k + j], mlen);
+				bp[j] = b[j];
+				mask |= 1u << j;
+			} else {
+				bp[j] = slh_zero;			//  idle lane
+			}
+			for (i = 0; i < 8; i++)
+				s[lanes * i + j] = sh->s512[i];
+		}
+		sha512_mb(s, bp, mask);
+		for (j = 0; j < lanes && k + j < cnt; j++) {
+			for (i = 0; i < 8; i++)
+				put64u_be(t + 8 * i, s[lanes * i + j]);
+			memcpy(md[k + j], t, sh->n);
+		}
+	}
+}
+
+//  SHAKE256: each state is filled directly, then sha3_keccakp_x()
+
+static void slh_shake_x(uint8_t * md[], const slh_hash_t * sh,
+						const uint8_t * const adrs[],
+						const uint8_t * const m[], size_t mlen, size_t cnt)
+{
+	int n = sh->n;
+	size_t i, k, l;
+	uint64_t st[SLH_X_MAX * 25];
+	uint8_t *b;
+
+	for (k = 0; k < cnt; k += l) {
+		l = cnt - k < SLH_X_MAX ? cnt - k : SLH_X_MAX;
+		memset(st, 0x00, l * 200);
+		for (i = 0; i < l; i++) {
+			b = (uint8_t *) & st[25 * i];
+			memcpy(b, sh->seed, n);
+			memcpy(b + n, adrs[k + i], SLH_ADRS);
+			memcpy(b + n + SLH_ADRS, m[k + i], mlen);
+			b[n + SLH_ADRS + mlen] = 0x1F;
+			b[135] ^= 0x80;
+		}
+		sha3_keccakp_x(st, l);
+		for (i = 0; i < l; i++)
+			memcpy(md[k + i], &st[25 * i], n);
+	}
+}
+
+void slh_f_x(uint8_t * md[], const slh_hash_t * sh,
+			 const uint8_t * const adrs[], const uint8_t * const m[],
+			 size_t cnt)
+{
+	if (sh->alg == SLH_SHA2)
+		slh_sha256_x(md, sh, adrs, m, sh->n, cnt);
+	else
+		slh_shake_x(md, sh, adrs, m, sh->n, cnt);
+}
+
+void slh_h_x(uint8_t * md[], const slh_hash_t * sh,
+			 const uint8_t * const adrs[], const uint8_t * const m[],
+			 size_t cnt)
+{
+	if (sh->alg == SLH_SHAKE)
+		slh_shake_x(md, sh, adrs, m, 2 * sh->n, cnt);
+	else if (sh->n == 16)
+		slh_sha256_x(md, sh, adrs, m, 32, cnt);
+	else
+		slh_sha512_x(md, sh, adrs, m, 2 * sh->n, cnt);
+}
@@ -0,0 +1,55 @@
+//  slh_hash.h
+//  2020-03-15  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  SLH-DSA (SPHINCS+) tweakable hash functions F, H, T_l, and PRF over
+//  SHA2 and SHAKE256 (FIPS 205 Sect. 11)
+
+#ifndef _SLH_HASH_H_
+#define _SLH_HASH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SLH_SHA2	0
+#define SLH_SHAKE	1
+
+#define SLH_ADRS	32						//  address bytes
+
+typedef struct {							//  tweakable hash instance
+	int alg, n;								//  SLH_xxx, hash bytes 16/24/32
+	uint8_t seed[32];						//  PK.seed
+	uint32_t s256[8];						//  SHA2-256 after PK.seed block
+	uint64_t s512[8];						//  SHA2-512 after PK.seed block
+} slh_hash_t;
+
+//  Set hash "alg" with "n"-byte PK.seed. For SHA2 the padded seed block is
+//  compressed here, once. Returns 0, or -1 if not supported.
+int slh_hash_init(slh_hash_t * sh, int alg, int n, const uint8_t * seed);
+
+//  F: "n" bytes from address "adrs" and n-byte "m" to "md".
+void slh_f(uint8_t * md, const slh_hash_t * sh,
+		   const uint8_t * adrs, const uint8_t * m);
+
+//  H: from 2n-byte "m".
+void slh_h(uint8_t * md, const slh_hash_t * sh,
+		   const uint8_t * adrs, const uint8_t * m);
+
+//  T_l: from "l" consecutive n-byte strings at "m".
+void slh_t(uint8_t * md, const slh_hash_t * sh,
+		   const uint8_t * adrs, const uint8_t * m, size_t l);
+
+//  PRF: from n-byte SK.seed "sk".
+void slh_prf(uint8_t * md, const slh_hash_t * sh,
+			 const uint8_t * adrs, const uint8_t * sk);
+
+//  "cnt" independent F or H evaluations md[i] from adrs[i] and m[i], one
+//  per lane of sha256_mb / sha512_mb (SHA2) or sha3_keccakp_x (SHAKE).
+void slh_f_x(uint8_t * md[], const slh_hash_t * sh,
+			 const uint8_t * const adrs[], const uint8_t * const m[],
+			 size_t cnt);
+void slh_h_x(uint8_t * md[], const slh_hash_t * sh,
+			 const uint8_t * const adrs[], const uint8_t * const m[],
+			 size_t cnt);
+
+#endif
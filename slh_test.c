@@ -0,0 +1,128 @@
+//  slh_test.c
+//  2020-03-15  Markku-Juhani O. Saarinen <mjos@pqshield.com>
+//  Copyright (c) 2020, PQShield Ltd. All rights reserved.
+
+//  Unit tests for the SLH-DSA tweakable hashes (FIPS 205 Sect. 11).
+
+#include "test_hex.h"
+#include "slh_hash.h"
+
+//  F, H, T_5, PRF for SHA2 and SHAKE with n = 16, 24, 32; computed with
+//  hashlib, outside this tree
+
+static const char *slh_tv[6][4] = {
+	{
+	 "A931E039FDC3048B56D0717E7EB67231",
+	 "B149835465B5B9E27F307937557B6945",
+	 "F760DB18DB68C93E8AC676BAEFBEC289",
+	 "79785D0FC9DEF94F4F4F3A6E1BAB3498" },
+	{
+	 "47B42E67EF1C5DDAB4C4E4778013A26C",
+	 "BD9EFB8224B1FC753ED782588A0AFFCC",
+	 "1861FD27EC04DA2C2E4BE753D8DB1425",
+	 "1575A35C879D95324886BA095602D15A" },
+	{
+	 "D3935EDA385D914903787443FD83A0EFEC199676FCA0CF70",
+	 "267848D6074150D7258A96D7EB4BBE3924960A81F961782C",
+	 "A0C1FA03404B9DF50D8B9874497FE362A0E6EC771A2E6C1F",
+	 "86606625AAFBC6C0200683DBF5151BDEDA23F4CC379A97E0" },
+	{
+	 "25DD6EF86C2974C8E803C59C65EB4A2D2D7B903CAD75D5CA",
+	 "B5B0FB9378A853DD10EA6F714CA5DBB6F748305366FFAFB1",
+	 "DB68D3C2F27B630B920F39150DBD8C8B7E0CAA5CA004A73A",
+	 "A709A895A08C6C3DC9FE0EF4036C44BD2371017F5F14C3B6" },
+	{
+	 "B9FB1F071A458733C3668A5BC8587F6CF5B153438672BB8E47D234A43D976C1D",
+	 "46922CD26F129A518F71BA6846462CD46D24A9AEAF5159E892F8BC63579E8BFE",
+	 "389AE04AA603F9F72184F316F4952B3086617D4A7C6E27A0B66B4AC6ABB9002A",
+	 "2F5FF7C472620037E25AE1AD8E54FE2358F9E8B65F8DC6E3E41A267A35855A40" },
+	{
+	 "0C38A6A0DF6CC4887BC5C640215A81CB59A78A0CFF14BD374C4DC438AF83F81E",
+	 "52CE10EE3BB6B73DCCFB93F118E42BC9F3D681A3324FA8595FC11AB6C88EAD8D",
+	 "BAFECA31A8CECC34A9B613529E491DFBC49C07648B10D8420F52C259EDDFA97D",
+	 "6C576BE858510B835F303C181AE7A14834A6E98DC49C2FB22299FF12BAB8EE6C" }
+};
+
+//  slh_f_x() and slh_h_x() against slh_f() and slh_h(), with fewer inputs
+//  than lanes and with more than any kernel has
+
+static int test_slh_x(const slh_hash_t * sh, const char *lab)
+{
+	size_t i, k;
+	int fail = 0;
+	const size_t cnt[2] = { 3, 35 };
+	uint8_t adrs[35][SLH_ADRS], m[35][64], md[35][32], ref[32];
+	const uint8_t *ap[35], *mp[35];
+	uint8_t *dp[35];
+
+	for (i = 0; i < 35; i++) {
+		memset(adrs[i], 0x00, SLH_ADRS);
+		adrs[i][19] = 3;					//  WOTS+ hash, chain i
+		adrs[i][23] = i;
+		memset(m[i], i ^ 0x5A, sizeof(m[i]));
+		ap[i] = adrs[i];
+		mp[i] = m[i];
+		dp[i] = md[i];
+	}
+
+	for (k = 0; k < 2; k++) {
+		slh_f_x(dp, sh, ap, mp, cnt[k]);
+		for (i = 0; i < cnt[k]; i++) {
+			slh_f(ref, sh, ap[i], mp[i]);
+			fail += memcmp(ref, md[i], sh->n) != 0;
+		}
+		slh_h_x(dp, sh, ap, mp, cnt[k]);
+		for (i = 0; i < cnt[k]; i++) {
+			slh_h(ref, sh, ap[i], mp[i]);
+			fail += memcmp(ref, md[i], sh->n) != 0;
+		}
+	}
+
+	return chkret(lab, 0, fail);
+}
+
+int test_slh_hash()
+{
+	int i, j, fail = 0;
+	uint8_t seed[32], adrs[SLH_ADRS], msg[160], md[32];
+	char lab[40];
+	const char *alg[2] = { "SHA2", "SHAKE" };
+	slh_hash_t sh;
+
+	for (i = 0; i < 32; i++)
+		seed[i] = 0x20 + i;
+	for (i = 0; i < SLH_ADRS; i++)
+		adrs[i] = 7 * i + 1;
+	for (i = 0; i < (int) sizeof(msg); i++)
+		msg[i] = 0x80 + i;
+
+	for (i = 0; i < 6; i++) {
+		j = 16 + 8 * (i >> 1);
+		fail += chkret("slh_hash_init()", 0,
+					   slh_hash_init(&sh, i & 1, j, seed));
+
+		snprintf(lab, sizeof(lab), "SLH-%s-%d F", alg[i & 1], j);
+		slh_f(md, &sh, adrs, msg);
+		fail += chkhex(lab, md, j, slh_tv[i][0]);
+
+		snprintf(lab, sizeof(lab), "SLH-%s-%d H", alg[i & 1], j);
+		slh_h(md, &sh, adrs, msg);
+		fail += chkhex(lab, md, j, slh_tv[i][1]);
+
+		snprintf(lab, sizeof(lab), "SLH-%s-%d T_5", alg[i & 1], j);
+		slh_t(md, &sh, adrs, msg, 5);
+		fail += chkhex(lab, md, j, slh_tv[i][2]);
+
+		snprintf(lab, sizeof(lab), "SLH-%s-%d PRF", alg[i & 1], j);
+		slh_prf(md, &sh, adrs, msg + j);
+		fail += chkhex(lab, md, j, slh_tv[i][3]);
+
+		snprintf(lab, sizeof(lab), "SLH-%s-%d lanes", alg[i & 1], j);
+		fail += test_slh_x(&sh, lab);
+	}
+
+	fail += chkret("slh_hash_init(n=20)", -1,
+				   slh_hash_init(&sh, SLH_SHA2, 20, seed));
+
+	return fail;
+}
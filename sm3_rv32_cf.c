@@ -5,6 +5,7 @@
 //  The Chinese Standard SM3 Hash Function
 //  GB/T 32905-2016, GM/T 0004-2012, ISO/IEC 10118-3:2018
 #include "sm3_wrap.h"
+#include "rv_endian.h"
 
 //  bitmanip (emulation) prototypes here
 #include "bitmanip.h"
@@ -60,123 +61,139 @@ uint32_t sm3_p1(uint32_t rs1)
 	tj = rv32b_ror(tj, 31);							}
 
 
-//  compression function (this one does *not* modify mp[])
+//  compress "nblocks" 64-byte blocks from "data" (any alignment)
 
-void rv32_sm3_compress(void *s)
+void rv32_sm3_blocks(uint32_t state[8], const uint8_t * data, size_t nblocks)
 {
 	int i;
 	uint32_t a, b, c, d, e, f, g, h;
 	uint32_t m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, ma, mb, mc, md, me, mf;
 	uint32_t tj, t, u;
 
-	uint32_t *sp = s;
-	const uint32_t *mp = sp + 8;
-
-	a = sp[0];
-	b = sp[1];
-	c = sp[2];
-	d = sp[3];
-	e = sp[4];
-	f = sp[5];
-	g = sp[6];
-	h = sp[7];
-
-	//  load with rev8.w
-
-	m0 = rv32b_grev(mp[0], 0x18);
-	m1 = rv32b_grev(mp[1], 0x18);
-	m2 = rv32b_grev(mp[2], 0x18);
-	m3 = rv32b_grev(mp[3], 0x18);
-	m4 = rv32b_grev(mp[4], 0x18);
-	m5 = rv32b_grev(mp[5], 0x18);
-	m6 = rv32b_grev(mp[6], 0x18);
-	m7 = rv32b_grev(mp[7], 0x18);
-	m8 = rv32b_grev(mp[8], 0x18);
-	m9 = rv32b_grev(mp[9], 0x18);
-	ma = rv32b_grev(mp[10], 0x18);
-	mb = rv32b_grev(mp[11], 0x18);
-	mc = rv32b_grev(mp[12], 0x18);
-	md = rv32b_grev(mp[13], 0x18);
-	me = rv32b_grev(mp[14], 0x18);
-	mf = rv32b_grev(mp[15], 0x18);
-
-	tj = 0x79CC4519;
-
-	SM3RF0(a, b, c, d, e, f, g, h, m0, m4);
-	SM3RF0(d, a, b, c, h, e, f, g, m1, m5);
-	SM3RF0(c, d, a, b, g, h, e, f, m2, m6);
-	SM3RF0(b, c, d, a, f, g, h, e, m3, m7);
-
-	SM3RF0(a, b, c, d, e, f, g, h, m4, m8);
-	SM3RF0(d, a, b, c, h, e, f, g, m5, m9);
-	SM3RF0(c, d, a, b, g, h, e, f, m6, ma);
-	SM3RF0(b, c, d, a, f, g, h, e, m7, mb);
-
-	SM3RF0(a, b, c, d, e, f, g, h, m8, mc);
-	SM3RF0(d, a, b, c, h, e, f, g, m9, md);
-	SM3RF0(c, d, a, b, g, h, e, f, ma, me);
-	SM3RF0(b, c, d, a, f, g, h, e, mb, mf);
-
-	SM3KEY(m0, m3, m7, ma, md);
-	SM3KEY(m1, m4, m8, mb, me);
-	SM3KEY(m2, m5, m9, mc, mf);
-	SM3KEY(m3, m6, ma, md, m0);
-
-	SM3RF0(a, b, c, d, e, f, g, h, mc, m0);
-	SM3RF0(d, a, b, c, h, e, f, g, md, m1);
-	SM3RF0(c, d, a, b, g, h, e, f, me, m2);
-	SM3RF0(b, c, d, a, f, g, h, e, mf, m3);
-
-	tj = 0x9D8A7A87;
-
-	for (i = 0; i < 3; i++) {
-
-		SM3KEY(m4, m7, mb, me, m1);
-		SM3KEY(m5, m8, mc, mf, m2);
-		SM3KEY(m6, m9, md, m0, m3);
-		SM3KEY(m7, ma, me, m1, m4);
-		SM3KEY(m8, mb, mf, m2, m5);
-		SM3KEY(m9, mc, m0, m3, m6);
-		SM3KEY(ma, md, m1, m4, m7);
-		SM3KEY(mb, me, m2, m5, m8);
-		SM3KEY(mc, mf, m3, m6, m9);
-		SM3KEY(md, m0, m4, m7, ma);
-		SM3KEY(me, m1, m5, m8, mb);
-		SM3KEY(mf, m2, m6, m9, mc);
-
-		SM3RF1(a, b, c, d, e, f, g, h, m0, m4);
-		SM3RF1(d, a, b, c, h, e, f, g, m1, m5);
-		SM3RF1(c, d, a, b, g, h, e, f, m2, m6);
-		SM3RF1(b, c, d, a, f, g, h, e, m3, m7);
-
-		SM3RF1(a, b, c, d, e, f, g, h, m4, m8);
-		SM3RF1(d, a, b, c, h, e, f, g, m5, m9);
-		SM3RF1(c, d, a, b, g, h, e, f, m6, ma);
-		SM3RF1(b, c, d, a, f, g, h, e, m7, mb);
-
-		SM3RF1(a, b, c, d, e, f, g, h, m8, mc);
-		SM3RF1(d, a, b, c, h, e, f, g, m9, md);
-		SM3RF1(c, d, a, b, g, h, e, f, ma, me);
-		SM3RF1(b, c, d, a, f, g, h, e, mb, mf);
+	a = state[0];
+	b = state[1];
+	c = state[2];
+	d = state[3];
+	e = state[4];
+	f = state[5];
+	g = state[6];
+	h = state[7];
+
+	for (; nblocks > 0; nblocks--) {
+
+		//  load with lw, rev8.w
+
+		m0 = ld32u_be(data);
+		m1 = ld32u_be(data + 4);
+		m2 = ld32u_be(data + 8);
+		m3 = ld32u_be(data + 12);
+		m4 = ld32u_be(data + 16);
+		m5 = ld32u_be(data + 20);
+		m6 = ld32u_be(data + 24);
+		m7 = ld32u_be(data + 28);
+		m8 = ld32u_be(data + 32);
+		m9 = ld32u_be(data + 36);
+		ma = ld32u_be(data + 40);
+		mb = ld32u_be(data + 44);
+		mc = ld32u_be(data + 48);
+		md = ld32u_be(data + 52);
+		me = ld32u_be(data + 56);
+		mf = ld32u_be(data + 60);
+		data += 64;
+
+		tj = 0x79CC4519;
+
+		SM3RF0(a, b, c, d, e, f, g, h, m0, m4);
+		SM3RF0(d, a, b, c, h, e, f, g, m1, m5);
+		SM3RF0(c, d, a, b, g, h, e, f, m2, m6);
+		SM3RF0(b, c, d, a, f, g, h, e, m3, m7);
+
+		SM3RF0(a, b, c, d, e, f, g, h, m4, m8);
+		SM3RF0(d, a, b, c, h, e, f, g, m5, m9);
+		SM3RF0(c, d, a, b, g, h, e, f, m6, ma);
+		SM3RF0(b, c, d, a, f, g, h, e, m7, mb);
+
+		SM3RF0(a, b, c, d, e, f, g, h, m8, mc);
+		SM3RF0(d, a, b, c, h, e, f, g, m9, md);
+		SM3RF0(c, d, a, b, g, h, e, f, ma, me);
+		SM3RF0(b, c, d, a, f, g, h, e, mb, mf);
 
 		SM3KEY(m0, m3, m7, ma, md);
 		SM3KEY(m1, m4, m8, mb, me);
 		SM3KEY(m2, m5, m9, mc, mf);
 		SM3KEY(m3, m6, ma, md, m0);
 
-		SM3RF1(a, b, c, d, e, f, g, h, mc, m0);
-		SM3RF1(d, a, b, c, h, e, f, g, md, m1);
-		SM3RF1(c, d, a, b, g, h, e, f, me, m2);
-		SM3RF1(b, c, d, a, f, g, h, e, mf, m3);
-
+		SM3RF0(a, b, c, d, e, f, g, h, mc, m0);
+		SM3RF0(d, a, b, c, h, e, f, g, md, m1);
+		SM3RF0(c, d, a, b, g, h, e, f, me, m2);
+		SM3RF0(b, c, d, a, f, g, h, e, mf, m3);
+
+		tj = 0x9D8A7A87;
+
+		for (i = 0; i < 3; i++) {
+
+			SM3KEY(m4, m7, mb, me, m1);
+			SM3KEY(m5, m8, mc, mf, m2);
+			SM3KEY(m6, m9, md, m0, m3);
+			SM3KEY(m7, ma, me, m1, m4);
+			SM3KEY(m8, mb, mf, m2, m5);
+			SM3KEY(m9, mc, m0, m3, m6);
+			SM3KEY(ma, md, m1, m4, m7);
+			SM3KEY(mb, me, m2, m5, m8);
+			SM3KEY(mc, mf, m3, m6, m9);
+			SM3KEY(md, m0, m4, m7, ma);
+			SM3KEY(me, m1, m5, m8, mb);
+			SM3KEY(mf, m2, m6, m9, mc);
+
+			SM3RF1(a, b, c, d, e, f, g, h, m0, m4);
+			SM3RF1(d, a, b, c, h, e, f, g, m1, m5);
+			SM3RF1(c, d, a, b, g, h, e, f, m2, m6);
+			SM3RF1(b, c, d, a, f, g, h, e, m3, m7);
+
+			SM3RF1(a, b, c, d, e, f, g, h, m4, m8);
+			SM3RF1(d, a, b, c, h, e, f, g, m5, m9);
+			SM3RF1(c, d, a, b, g, h, e, f, m6, ma);
+			SM3RF1(b, c, d, a, f, g, h, e, m7, mb);
+
+			SM3RF1(a, b, c, d, e, f, g, h, m8, mc);
+			SM3RF1(d, a, b, c, h, e, f, g, m9, md);
+			SM3RF1(c, d, a, b, g, h, e, f, ma, me);
+			SM3RF1(b, c, d, a, f, g, h, e, mb, mf);
+
+			SM3KEY(m0, m3, m7, ma, md);
+			SM3KEY(m1, m4, m8, mb, me);
+			SM3KEY(m2, m5, m9, mc, mf);
+			SM3KEY(m3, m6, ma, md, m0);
+
+			SM3RF1(a, b, c, d, e, f, g, h, mc, m0);
+			SM3RF1(d, a, b, c, h, e, f, g, md, m1);
+			SM3RF1(c, d, a, b, g, h, e, f, me, m2);
+			SM3RF1(b, c, d, a, f, g, h, e, mf, m3);
+
+		}
+
+		a = a ^ state[0];					//  feed-forward, a..h carry on
+		b = b ^ state[1];
+		c = c ^ state[2];
+		d = d ^ state[3];
+		e = e ^ state[4];
+		f = f ^ state[5];
+		g = g ^ state[6];
+		h = h ^ state[7];
+		state[0] = a;
+		state[1] = b;
+		state[2] = c;
+		state[3] = d;
+		state[4] = e;
+		state[5] = f;
+		state[6] = g;
+		state[7] = h;
 	}
+}
 
-	sp[0] = sp[0] ^ a;
-	sp[1] = sp[1] ^ b;
-	sp[2] = sp[2] ^ c;
-	sp[3] = sp[3] ^ d;
-	sp[4] = sp[4] ^ e;
-	sp[5] = sp[5] ^ f;
-	sp[6] = sp[6] ^ g;
-	sp[7] = sp[7] ^ h;
+//  compression function of the old layout: state s[0..7], block s[8..23]
+
+void rv32_sm3_compress(void *s)
+{
+	rv32_sm3_blocks((uint32_t *) s, (const uint8_t *) s + 32, 1);
 }
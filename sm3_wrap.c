@@ -11,59 +11,97 @@
 #include "sm3_wrap.h"
 
 //  pointer to the compression functions
-void (*sm3_compress)(void *s) = &rv32_sm3_compress;
+void (*sm3_blocks)(uint32_t *, const uint8_t *, size_t) = &rv32_sm3_blocks;
 
-//  Compute 32-byte message digest to "md" from "in" which has "inlen" bytes
+//  initial values
 
-void sm3_256(uint8_t * md, const void *in, size_t inlen)
+void sm3_init(sm3_ctx_t * c)
 {
-	size_t i;
-	uint64_t x;
-	uint32_t t, s[8 + 16];
+	c->s[0] = 0x7380166F;
+	c->s[1] = 0x4914B2B9;
+	c->s[2] = 0x172442D7;
+	c->s[3] = 0xDA8A0600;
+	c->s[4] = 0xA96F30BC;
+	c->s[5] = 0x163138AA;
+	c->s[6] = 0xE38DEE4D;
+	c->s[7] = 0xB0FB0E4E;
+	c->len = 0;
+}
+
+//  absorb any number of bytes; only a partial block is buffered
 
-	uint8_t *mp = (uint8_t *) & s[8];
+void sm3_update(sm3_ctx_t * c, const void *in, size_t inlen)
+{
+	size_t i;
 	const uint8_t *p = in;
 
-	//  initial values
-	s[0] = 0x7380166F;
-	s[1] = 0x4914B2B9;
-	s[2] = 0x172442D7;
-	s[3] = 0xDA8A0600;
-	s[4] = 0xA96F30BC;
-	s[5] = 0x163138AA;
-	s[6] = 0xE38DEE4D;
-	s[7] = 0xB0FB0E4E;
-
-	//  "md padding"
-	x = inlen << 3;							//  length in bits
-
-	while (inlen >= 64) {					//  full blocks
-		memcpy(mp, p, 64);
-		sm3_compress(s);
-		inlen -= 64;
-		p += 64;
+	i = c->len & 63;
+	c->len += inlen;
+
+	if (i > 0) {
+		if (i + inlen < 64) {				//  still no full block
+			memcpy(c->b + i, p, inlen);
+			return;
+		}
+		memcpy(c->b + i, p, 64 - i);
+		sm3_blocks(c->s, c->b, 1);
+		inlen -= 64 - i;
+		p += 64 - i;
 	}
-	memcpy(mp, p, inlen);					//  last data block
-	mp[inlen++] = 0x80;
-	if (inlen > 56) {
-		memset(mp + inlen, 0x00, 64 - inlen);
-		sm3_compress(s);
-		inlen = 0;
+
+	if (inlen >= 64) {						//  full blocks, in place
+		sm3_blocks(c->s, p, inlen >> 6);
+		p += inlen & ~((size_t) 63);
+		inlen &= 63;
 	}
-	i = 64;									//  process length
-	while (x > 0) {
-		mp[--i] = x & 0xFF;
-		x >>= 8;
+	memcpy(c->b, p, inlen);					//  keep the rest
+}
+
+//  "md padding" and 32-byte output to "md"
+
+void sm3_final(uint8_t * md, sm3_ctx_t * c)
+{
+	size_t i;
+	uint32_t t;
+	uint8_t *mp = c->b;
+
+	i = c->len & 63;						//  last data block
+	mp[i++] = 0x80;
+	if (i > 56) {
+		memset(mp + i, 0x00, 64 - i);
+		sm3_blocks(c->s, mp, 1);
+		i = 0;
 	}
-	memset(&mp[inlen], 0x00, i - inlen);
-	sm3_compress(s);
+	memset(mp + i, 0x00, 56 - i);
+	t = c->len >> 29;						//  length in bits
+	mp[56] = t >> 24;
+	mp[57] = (t >> 16) & 0xFF;
+	mp[58] = (t >> 8) & 0xFF;
+	mp[59] = t & 0xFF;
+	t = c->len << 3;
+	mp[60] = t >> 24;
+	mp[61] = (t >> 16) & 0xFF;
+	mp[62] = (t >> 8) & 0xFF;
+	mp[63] = t & 0xFF;
+	sm3_blocks(c->s, mp, 1);
 
 	//  store big endian output
 	for (i = 0; i < 32; i += 4) {
-		t = s[i >> 2];
+		t = c->s[i >> 2];
 		md[i] = t >> 24;
 		md[i + 1] = (t >> 16) & 0xFF;
 		md[i + 2] = (t >> 8) & 0xFF;
 		md[i + 3] = t & 0xFF;
 	}
 }
+
+//  Compute 32-byte message digest to "md" from "in" which has "inlen" bytes
+
+void sm3_256(uint8_t * md, const void *in, size_t inlen)
+{
+	sm3_ctx_t c;
+
+	sm3_init(&c);
+	sm3_update(&c, in, inlen);
+	sm3_final(md, &c);
+}
@@ -14,10 +14,24 @@
 //  Compute 32-byte hash to "md" from "in" which has "inlen" bytes (sm3.c)
 void sm3_256(uint8_t * md, const void *in, size_t inlen);
 
-//  function pointer to the compression function (sm3.c)
-extern void (*sm3_compress)(void *);
+//  incremental interface
+typedef struct {							//  SM3 context
+	uint32_t s[8];							//  chaining state
+	uint8_t b[64];							//  partial block
+	uint64_t len;							//  bytes processed
+} sm3_ctx_t;
 
-//  SM3 compression function for RV32 (rv32_sm3.c)
+void sm3_init(sm3_ctx_t * c);
+void sm3_update(sm3_ctx_t * c, const void *in, size_t inlen);
+void sm3_final(uint8_t * md, sm3_ctx_t * c);	//  32 bytes to "md"
+
+//  function pointer to the multi-block compression function (sm3.c)
+extern void (*sm3_blocks)(uint32_t *, const uint8_t *, size_t);
+
+//  SM3 compression of "nblocks" 64-byte blocks for RV32 (rv32_sm3.c)
+void rv32_sm3_blocks(uint32_t state[8], const uint8_t * data, size_t nblocks);
+
+//  single block, state s[0..7] followed by the block (rv32_sm3.c)
 void rv32_sm3_compress(void *s);
 
 #endif
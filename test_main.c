@@ -11,52 +11,204 @@
 
 int test_sha2_256();						//  test_sha2.c
 int test_sha2_512();
+int test_sha2_512t();
 int test_sha2_hmac();
+int test_sha2_ctx();
+int test_sha2_hmac_key();
+int test_sha2_scan();
+int test_sha2_64b();
+int test_sha2_batch();
+int test_sha2_x2();
+int test_sha2_x2_ops();
+int test_sha2_sigma();
+int test_sha2_512_ops();
+int test_sha2_pbkdf2();
+int test_sha2_pbkdf2_batch();
+int test_sha2_hkdf();
+int test_sha2_hkdf_batch();
+int test_sha2_drbg();
 
 int test_keccakp();							//  test_sha3.c
 int test_sha3();
 int test_shake();
+int test_sha3_rate();
+int test_keccakp_x();
+int test_sha3_x();
+int test_keccakp_pl_count();
 
 int test_sm3();								//  test_sm3.c
 
+int test_slh_hash();						//  slh_test.c
+
+int test_hash_chain();						//  chain_test.c
+
+int test_merkle();							//  merkle_test.c
+int test_merkle_log();
+
 //  stub main
 
 int main(int argc, char **argv)
 {
 	int fail = 0;
 
-	printf("[INFO] === SHA2-256 using rv32_sha256_compress() ===\n");
-	sha256_compress = rv32_sha256_compress;
+	printf("[INFO] === SHA2-256 using rv32_sha256_blocks() ===\n");
+	sha256_blocks = rv32_sha256_blocks;
 	fail += test_sha2_256();
 
-	printf("[INFO] === SHA2-512 using rv64_sha512_compress() ===\n");
-	sha512_compress = rv64_sha512_compress;
+	printf("[INFO] === SHA2-512 using rv64_sha512_blocks() ===\n");
+	sha512_blocks = rv64_sha512_blocks;
 	fail += test_sha2_512();
+	fail += test_sha2_512t();
 
-	printf("[INFO] === SHA2-512 using rv32_sha512_compress() ===\n");
-	sha512_compress = rv32_sha512_compress;
+	printf("[INFO] === SHA2-512 using rv32_sha512_blocks() ===\n");
+	sha512_blocks = rv32_sha512_blocks;
+	fail += test_sha2_512();
+	fail += test_sha2_512t();
+	fail += test_sha2_ctx();
+
+	printf("[INFO] === SHA2-512 using rv32_sha512_blocks_adc() ===\n");
+	sha512_blocks = rv32_sha512_blocks_adc;
+	fail += test_sha2_512();
+	fail += test_sha2_512t();
+	fail += test_sha2_ctx();
+	fail += test_sha2_512_ops();
+
+#if defined(__riscv) && (__riscv_xlen == 32) && \
+	defined(__riscv_zknh) && defined(__riscv_zbkb)
+	printf("[INFO] === SHA2-512 using rv32_sha512_blocks_asm() ===\n");
+	sha512_blocks = rv32_sha512_blocks_asm;
 	fail += test_sha2_512();
+	fail += test_sha2_512t();
+	fail += test_sha2_ctx();
+#endif
+
+#ifdef __SSE2__
+	printf("[INFO] === SHA2 using x86_sha256_blocks() x86_sha512_blocks() ===\n");
+	sha256_blocks = x86_sha256_blocks;
+	sha512_blocks = x86_sha512_blocks;
+	fail += test_sha2_256();
+	fail += test_sha2_512();
+	fail += test_sha2_512t();
+	fail += test_sha2_ctx();
+	fail += test_sha2_hmac();
+#endif
 
-	printf("[INFO] === rv32_sha256_compress() rv64_sha512_compress() ===\n");
-	sha256_compress = rv32_sha256_compress;
-	sha512_compress = rv64_sha512_compress;
+	printf("[INFO] === rv32_sha256_blocks() rv64_sha512_blocks() ===\n");
+	sha256_blocks = rv32_sha256_blocks;
+	sha512_blocks = rv64_sha512_blocks;
+	fail += test_sha2_sigma();
 	fail += test_sha2_hmac();
+	fail += test_sha2_ctx();
+	fail += test_sha2_hmac_key();
+	fail += test_sha2_scan();
+	fail += test_sha2_64b();
+	fail += test_sha2_x2();
+	fail += test_sha2_pbkdf2();
+	fail += test_sha2_hkdf();
+	fail += test_sha2_drbg();
+
+	printf("[INFO] === SHA2-256 two-lane SWAR using rv64_sha256_blocks_x2() ===\n");
+	sha256_blocks_x2 = rv64_sha256_blocks_x2;
+	fail += test_sha2_x2();
+	fail += test_sha2_x2_ops();
+
+	printf("[INFO] === SHA2 multi-buffer using c_sha256_x8() c_sha512_x4() ===\n");
+	sha256_mb_lanes = 8;
+	sha256_mb = c_sha256_x8;
+	sha512_mb_lanes = 4;
+	sha512_mb = c_sha512_x4;
+	fail += test_sha2_batch();
+	fail += test_sha2_pbkdf2_batch();
+	fail += test_sha2_hkdf_batch();
+	fail += test_slh_hash();
+	fail += test_hash_chain();
+
+#ifdef __AVX2__
+	printf("[INFO] === SHA2 multi-buffer using avx2_sha256_x8() avx2_sha512_x4() ===\n");
+	sha256_mb_lanes = 8;
+	sha256_mb = avx2_sha256_x8;
+	sha512_mb_lanes = 4;
+	sha512_mb = avx2_sha512_x4;
+	fail += test_sha2_batch();
+	fail += test_sha2_pbkdf2_batch();
+	fail += test_sha2_hkdf_batch();
+	fail += test_slh_hash();
+	fail += test_hash_chain();
+#endif
+
+#ifdef __AVX512F__
+	printf("[INFO] === SHA2 multi-buffer using avx512_sha256_x16() avx512_sha512_x8() ===\n");
+	sha256_mb_lanes = 16;
+	sha256_mb = avx512_sha256_x16;
+	sha512_mb_lanes = 8;
+	sha512_mb = avx512_sha512_x8;
+	fail += test_sha2_batch();
+	fail += test_sha2_pbkdf2_batch();
+	fail += test_sha2_hkdf_batch();
+	fail += test_slh_hash();
+	fail += test_hash_chain();
+#endif
 
 	printf("[INFO] === SHA3 using rv32_keccakp() ===\n");
 	sha3_keccakp = rv32_keccakp;
 	fail += test_keccakp();
 	fail += test_sha3();
 	fail += test_shake();
+	fail += test_sha3_rate();
+
+	printf("[INFO] === SHA3 using rv32_keccakp_pl() ===\n");
+	sha3_keccakp = rv32_keccakp_pl;
+	fail += test_keccakp();
+	fail += test_sha3();
+	fail += test_shake();
+	fail += test_keccakp_pl_count();
 
 	printf("[INFO] === SHA3 using rv64_keccakp() ===\n");
 	sha3_keccakp = rv64_keccakp;
 	fail += test_keccakp();
 	fail += test_sha3();
 	fail += test_shake();
+	fail += test_sha3_rate();
+	fail += test_sha3_x();
+
+#if defined(__riscv) && (__riscv_xlen == 64) && defined(__riscv_zbb)
+	printf("[INFO] === SHA3 using rv64_keccakp_asm() ===\n");
+	sha3_keccakp = rv64_keccakp_asm;
+	fail += test_keccakp();
+	fail += test_sha3();
+	fail += test_shake();
+	fail += test_sha3_rate();
+#endif
+
+#ifdef __riscv_vector
+	printf("[INFO] === SHA3 using rvv_keccakp_x() ===\n");
+	sha3_keccakp_x = rvv_keccakp_x;
+	fail += test_keccakp_x();
+	fail += test_sha3_x();
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_SHA3)
+	printf("[INFO] === SHA3 using arm_keccakp() ===\n");
+	sha3_keccakp = arm_keccakp;
+	fail += test_keccakp();
+	fail += test_sha3();
+	fail += test_shake();
+	fail += test_sha3_rate();
+
+	printf("[INFO] === SHA3 using arm_keccakp_x() ===\n");
+	sha3_keccakp = rv64_keccakp;
+	sha3_keccakp_x = arm_keccakp_x;
+	fail += test_keccakp_x();
+	fail += test_sha3_x();
+#endif
 
 	printf("[INFO] === SM3 tests ===\n");
 	fail += test_sm3();
 
+	printf("[INFO] === Merkle tree tests ===\n");
+	fail += test_merkle();
+	fail += test_merkle_log();
+
 	printf("[%s] === finished with %d unit test failures ===\n",
 		   fail == 0 ? "PASS" : "FAIL", fail);
 